@@ -0,0 +1,37 @@
+//
+//  BitAdjacency.h
+//  FastGraph
+//
+//  Created by culter on 10/18/26.
+//  Copyright © 2026 culter. All rights reserved.
+//
+
+#ifndef BitAdjacency_h
+#define BitAdjacency_h
+
+#include <vector>
+
+#include "FastGraph.h"
+#include "NodeSet.h"
+
+// Successor and predecessor rows as bitsets, so a whole BFS level can be expanded
+// with word-wide ORs instead of one branch per neighbor.
+template<size_t Capacity>
+struct BitAdjacency {
+  std::vector<BitNodeSet<Capacity>> succ;
+  std::vector<BitNodeSet<Capacity>> pred;
+};
+
+template<size_t Capacity, typename TGraph>
+BitAdjacency<Capacity> make_bit_adjacency(const TGraph& g) {
+  BitAdjacency<Capacity> answer;
+  answer.succ.resize(g.nodes.size(), BitNodeSet<Capacity>{});
+  answer.pred.resize(g.nodes.size(), BitNodeSet<Capacity>{});
+  for (size_t v = 0; v < g.nodes.size(); ++v) {
+    flatten(answer.succ[v], g.nodes[v].succ_cbegin(), g.nodes[v].succ_cend());
+    flatten(answer.pred[v], g.nodes[v].pred_cbegin(), g.nodes[v].pred_cend());
+  }
+  return answer;
+}
+
+#endif /* BitAdjacency_h */
@@ -9,10 +9,57 @@
 #ifndef Config_h
 #define Config_h
 
+#include <cstdint>
+
 // Basic strategy choices
 constexpr bool k_close_all_genes = false;
 constexpr bool k_close_after_one_third = false;
 constexpr bool k_optimize_after_two_thirds = true;
+// Search every strongly connected component instead of only the one containing node 0.
+constexpr bool k_solve_all_components = false;
+// Split the graph at cut vertices of its undirected view and search each block separately.
+constexpr bool k_split_into_blocks = false;
+// Drop duplicate and acyclic edges and contract forced chains into weighted nodes before searching.
+constexpr bool k_reduce_graph = false;
+// Split each generation's crossover and mutation across the shared pool, with a random stream
+// per site and per gene. Results depend on the seed only, not on the thread count; false
+// keeps the original serial loop and its single random stream.
+constexpr bool k_parallel_generations = true;
+// How islands share genes. merge: pairs merge at the end of each epoch, in a fixed order.
+// async: every k_report_record_period generations, each island sends copies of its
+// k_migrants best genes to its two ring neighbors' lock-free inboxes; no island ever waits.
+// shared: as async, but genes go to a ring in shared memory that every FastGraph process on
+// this host searching the same graph reads, so processes can be started and stopped mid-run.
+enum class Migration { merge, async, shared };
+constexpr Migration k_migration = Migration::merge;
+constexpr int k_migrants = 4;
+// Shared memory name prefix; the graph's fingerprint is appended.
+constexpr const char* k_shared_ring_name = "/fastgraph-";
+
+// Data layout choices
+// Node numbering for the search; input keeps first-appearance order from edges.txt.
+enum class NodeOrder { input, bfs, rcm, degree };
+constexpr NodeOrder k_node_order = NodeOrder::input;
+constexpr bool k_bit_packed_node_sets = true;
+// Compressed sparse rows instead of fixed Node arrays: no degree limit, no padding.
+// Only the SCC of node 0 is searched; snapshots, reduction and component modes need Node.
+constexpr bool k_csr_graph = false;
+// Search with the smallest index type and Node size that fit the prepared graph.
+constexpr bool k_tightest_node_types = true;
+// A successor bit row per node beside the neighbor lists, for O(1) edge tests.
+constexpr bool k_edge_matrix = true;
+// Every node's dominator tree, so crossover and mutation can skip searches that a forbidden
+// dominator already rules out. n^2 entries: 2048 nodes take 16 MB, and larger graphs go without.
+constexpr bool k_dominator_filter = true;
+constexpr size_t k_dominator_max_nodes = 2048;
+
+// Input
+// After the first run, the prepared graph is reloaded from this file instead of edges.txt.
+constexpr bool k_use_snapshot = true;
+constexpr const char* k_snapshot_path = "graph.snapshot";
+// Threads that parse chunks of edges.txt at once; 0 means one per hardware thread.
+// Node numbering is the same for any count.
+constexpr unsigned k_parse_threads = 0;
 
 // Knobs to tune
 constexpr int k_random_seed = 123456;
@@ -0,0 +1,202 @@
+//
+//  CsrGraph.h
+//  FastGraph
+//
+//  Created by culter on 10/18/26.
+//  Copyright © 2026 culter. All rights reserved.
+//
+
+#ifndef CsrGraph_h
+#define CsrGraph_h
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "DominatorTable.h"
+#include "EdgeMatrix.h"
+#include "FastGraph.h"
+#include "Node.h"
+
+// One node's neighbors: two slices of the graph's shared arrays. Cheap to build and copy,
+// and only valid while the graph is unchanged.
+template<typename TIndex>
+class CsrNode {
+  const TIndex* succ_first;
+  const TIndex* succ_last;
+  const TIndex* pred_first;
+  const TIndex* pred_last;
+
+public:
+  CsrNode(const TIndex* succ_first, const TIndex* succ_last, const TIndex* pred_first, const TIndex* pred_last)
+  : succ_first(succ_first), succ_last(succ_last), pred_first(pred_first), pred_last(pred_last) {}
+
+  uint32_t get_out_degree() const { return (uint32_t)(succ_last - succ_first); }
+  uint32_t get_in_degree() const { return (uint32_t)(pred_last - pred_first); }
+
+  const TIndex* succ_cbegin() const { return succ_first; }
+  const TIndex* succ_cend() const { return succ_last; }
+  const TIndex* pred_cbegin() const { return pred_first; }
+  const TIndex* pred_cend() const { return pred_last; }
+};
+
+// Compressed sparse rows: every successor list back to back in one array, every
+// predecessor list in another, and an offset per node into each. A node costs exactly its
+// degree, and there is no MaxDegree to overflow. nodes[v] reads like a Node, but is a view.
+template<typename TIndex>
+struct CsrNodes {
+  std::vector<uint32_t> succ_offsets;
+  std::vector<TIndex> succ;
+  std::vector<uint32_t> pred_offsets;
+  std::vector<TIndex> pred;
+
+  size_t size() const { return succ_offsets.empty() ? 0 : succ_offsets.size() - 1; }
+  bool empty() const { return size() == 0; }
+
+  // Makes n nodes with no edges.
+  void resize(size_t n) {
+    succ_offsets.assign(n + 1, 0);
+    pred_offsets.assign(n + 1, 0);
+    succ.clear();
+    pred.clear();
+  }
+
+  CsrNode<TIndex> operator[](size_t v) const {
+    return CsrNode<TIndex>(succ.data() + succ_offsets[v], succ.data() + succ_offsets[v + 1],
+                           pred.data() + pred_offsets[v], pred.data() + pred_offsets[v + 1]);
+  }
+};
+
+// Same fields as FastGraph, so has_path, the crossovers, the mutations and evolve
+// run on either one.
+template<typename TIndex>
+struct CsrGraph {
+  typedef TIndex index_type;
+
+  CsrNodes<TIndex> nodes;
+  std::vector<std::string> names;
+  std::vector<uint32_t> original_ids;
+  std::vector<uint32_t> weights;
+
+  // Optional O(1) edge tests; filled in by index_edges.
+  EdgeMatrix edge_matrix;
+  // Optional proof that a path is cut off; filled in by index_dominators.
+  DominatorTable dominators;
+
+  // Scans v's successors unless there is an edge matrix. Whatever renumbers nodes clears it,
+  // so a matrix of the right size is current.
+  bool has_edge(size_t v, size_t w) const {
+    if (edge_matrix.size() == nodes.size()) return edge_matrix.has_edge(v, w);
+    return std::find(nodes[v].succ_cbegin(), nodes[v].succ_cend(), w) != nodes[v].succ_cend();
+  }
+  
+  // Cleared with the edge matrix, so a table of the right size is current.
+  bool has_dominators() const { return !dominators.empty() && dominators.size() == nodes.size(); }
+
+  size_t weight(size_t i) const { return weights.empty() ? 1 : weights[i]; }
+  size_t total_weight() const {
+    size_t answer = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) answer += weight(i);
+    return answer;
+  }
+
+  void check() const {
+    assert(nodes.pred_offsets.size() == nodes.succ_offsets.size());
+    assert(nodes.succ.size() == nodes.pred.size());
+    for (const TIndex w: nodes.succ) {
+      assert(w < nodes.size());
+      (void)w;
+    }
+    for (const TIndex w: nodes.pred) {
+      assert(w < nodes.size());
+      (void)w;
+    }
+  }
+};
+
+// Two counting sorts over the edge list. Each node's successors come out in edge-list order,
+// and so do its predecessors, exactly as build_adjacency orders them for Node.
+template<typename TIndex>
+void build_adjacency(CsrGraph<TIndex>& g, const std::vector<std::pair<uint32_t, uint32_t>>& edges) {
+  CsrNodes<TIndex>& nodes = g.nodes;
+  const size_t n = nodes.size();
+  nodes.succ_offsets.assign(n + 1, 0);
+  nodes.pred_offsets.assign(n + 1, 0);
+  for (const auto& edge: edges) {
+    nodes.succ_offsets[edge.first + 1] += 1;
+    nodes.pred_offsets[edge.second + 1] += 1;
+  }
+  for (size_t v = 0; v < n; ++v) {
+    nodes.succ_offsets[v + 1] += nodes.succ_offsets[v];
+    nodes.pred_offsets[v + 1] += nodes.pred_offsets[v];
+  }
+
+  nodes.succ.resize(edges.size());
+  nodes.pred.resize(edges.size());
+  std::vector<uint32_t> succ_next(nodes.succ_offsets.begin(), nodes.succ_offsets.end() - 1);
+  std::vector<uint32_t> pred_next(nodes.pred_offsets.begin(), nodes.pred_offsets.end() - 1);
+  for (const auto& edge: edges) {
+    nodes.succ[succ_next[edge.first]++] = edge.second;
+    nodes.pred[pred_next[edge.second]++] = edge.first;
+  }
+}
+
+// Drops every node without keep[i], preserving the order of the survivors and of their
+// neighbor lists, like compact for FastGraph.
+template<typename TIndex>
+std::vector<uint32_t> compact(CsrGraph<TIndex>& g, const std::vector<bool>& keep) {
+  std::vector<uint32_t> remap(g.nodes.size(), UINT32_MAX);
+  uint32_t kept = 0;
+  for (size_t i = 0; i < g.nodes.size(); ++i) {
+    if (keep[i]) remap[i] = kept++;
+  }
+
+  CsrGraph<TIndex> answer;
+  answer.nodes.succ_offsets.reserve(kept + 1);
+  answer.nodes.pred_offsets.reserve(kept + 1);
+  answer.nodes.succ_offsets.push_back(0);
+  answer.nodes.pred_offsets.push_back(0);
+  for (size_t i = 0; i < g.nodes.size(); ++i) {
+    if (!keep[i]) continue;
+    const CsrNode<TIndex> node = g.nodes[i];
+    for (auto w = node.succ_cbegin(); w != node.succ_cend(); ++w) {
+      if (keep[*w]) answer.nodes.succ.push_back(remap[*w]);
+    }
+    for (auto w = node.pred_cbegin(); w != node.pred_cend(); ++w) {
+      if (keep[*w]) answer.nodes.pred.push_back(remap[*w]);
+    }
+    answer.nodes.succ_offsets.push_back((uint32_t)answer.nodes.succ.size());
+    answer.nodes.pred_offsets.push_back((uint32_t)answer.nodes.pred.size());
+    answer.names.push_back(g.names[i]);
+    answer.original_ids.push_back(g.original_ids[i]);
+    if (!g.weights.empty()) answer.weights.push_back(g.weights[i]);
+  }
+
+  // answer has no edge matrix or dominator table, so g's, which no longer match the
+  // numbering, go too.
+  g = std::move(answer);
+  return remap;
+}
+
+// Same graph, same node ids, same neighbor order.
+template<typename TIndex, typename TDegree, size_t MaxDegree>
+CsrGraph<TIndex> make_csr(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g) {
+  CsrGraph<TIndex> answer;
+  answer.nodes.succ_offsets.push_back(0);
+  answer.nodes.pred_offsets.push_back(0);
+  for (const auto& node: g.nodes) {
+    answer.nodes.succ.insert(answer.nodes.succ.end(), node.succ_cbegin(), node.succ_cend());
+    answer.nodes.pred.insert(answer.nodes.pred.end(), node.pred_cbegin(), node.pred_cend());
+    answer.nodes.succ_offsets.push_back((uint32_t)answer.nodes.succ.size());
+    answer.nodes.pred_offsets.push_back((uint32_t)answer.nodes.pred.size());
+  }
+  answer.names = g.names;
+  answer.original_ids = g.original_ids;
+  answer.weights = g.weights;
+  return answer;
+}
+
+#endif /* CsrGraph_h */
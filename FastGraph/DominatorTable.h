@@ -0,0 +1,173 @@
+//
+//  DominatorTable.h
+//  FastGraph
+//
+//  Created by culter on 10/18/26.
+//  Copyright © 2026 culter. All rights reserved.
+//
+
+#ifndef DominatorTable_h
+#define DominatorTable_h
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// The dominator tree of the graph from every node: row s holds each node's immediate
+// dominator on paths from s. Every path from s to t passes through each node on the chain
+// from t up to s, so if the forbidden set holds one of them there is no path, and no search
+// is needed to find that out. A node s cannot reach has no dominator and is marked
+// unreachable. n^2 entries, so it is only built for graphs up to k_dominator_max_nodes.
+constexpr static const uint32_t k_unreachable = UINT32_MAX;
+
+struct DominatorTable {
+  size_t node_count;
+  std::vector<uint32_t> idom;
+
+  DominatorTable(): node_count(0) {}
+
+  bool empty() const { return idom.empty(); }
+  size_t size() const { return node_count; }
+
+  // True if every path from source to target passes through forbidden_nodes. False means
+  // only that the table cannot tell.
+  template<typename TSet>
+  bool blocks(size_t source, size_t target, const TSet& forbidden_nodes) const {
+    const uint32_t* row = idom.data() + source * node_count;
+    for (uint32_t d = row[target]; d != source; d = row[d]) {
+      if (d == k_unreachable || forbidden_nodes[d]) return true;
+    }
+    return false;
+  }
+};
+
+// Scratch for one source's dominator tree.
+struct DominatorScratch {
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> rank;
+  std::vector<uint32_t> stack;
+  std::vector<uint32_t> next_child;
+};
+
+// Immediate dominators from source into row, by Cooper, Harvey and Kennedy's iteration over
+// reverse postorder, which converges in a few passes on graphs like these.
+template<typename TGraph>
+void dominators_from(const TGraph& g, uint32_t source, uint32_t* row, DominatorScratch& scratch) {
+  const uint32_t n = (uint32_t)g.nodes.size();
+  std::vector<uint32_t>& order = scratch.order;
+  std::vector<uint32_t>& rank = scratch.rank;
+  std::vector<uint32_t>& stack = scratch.stack;
+  std::vector<uint32_t>& next_child = scratch.next_child;
+
+  // Postorder by iterative DFS; rank is then the position in reverse postorder.
+  order.clear();
+  rank.assign(n, k_unreachable);
+  next_child.assign(n, 0);
+  stack.assign(1, source);
+  rank[source] = 0;
+  while (!stack.empty()) {
+    const uint32_t v = stack.back();
+    if (next_child[v] < g.nodes[v].get_out_degree()) {
+      const uint32_t w = g.nodes[v].succ_cbegin()[next_child[v]++];
+      if (rank[w] == k_unreachable) {
+        rank[w] = 0;
+        stack.push_back(w);
+      }
+    } else {
+      order.push_back(v);
+      stack.pop_back();
+    }
+  }
+  std::reverse(order.begin(), order.end());
+  for (uint32_t i = 0; i < order.size(); ++i) {
+    rank[order[i]] = i;
+  }
+
+  for (uint32_t v = 0; v < n; ++v) {
+    row[v] = k_unreachable;
+  }
+  row[source] = source;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t i = 1; i < order.size(); ++i) {
+      const uint32_t v = order[i];
+      uint32_t dominator = k_unreachable;
+      for (auto p = g.nodes[v].pred_cbegin(); p != g.nodes[v].pred_cend(); ++p) {
+        if (row[*p] == k_unreachable) continue;
+        if (dominator == k_unreachable) {
+          dominator = *p;
+          continue;
+        }
+        uint32_t a = *p;
+        uint32_t b = dominator;
+        while (a != b) {
+          while (rank[a] > rank[b]) a = row[a];
+          while (rank[b] > rank[a]) b = row[b];
+        }
+        dominator = a;
+      }
+      if (row[v] != dominator) {
+        row[v] = dominator;
+        changed = true;
+      }
+    }
+  }
+}
+
+// Builds g.dominators, one source per task on the shared pool, unless g has more than
+// max_nodes nodes. Like the edge matrix, the table is cleared by anything that renumbers or
+// removes nodes.
+template<typename TGraph>
+void index_dominators(TGraph& g, size_t max_nodes) {
+  DominatorTable& table = g.dominators;
+  const size_t n = g.nodes.size();
+  if (n > max_nodes) return;
+  table.node_count = n;
+  table.idom.assign(n * n, k_unreachable);
+  ThreadPool& pool = shared_pool();
+  std::vector<DominatorScratch> scratch(pool.size() + 1);
+  parallel_for(pool, n, [&](size_t begin, size_t end) {
+    DominatorScratch& mine = scratch[pool.worker_index()];
+    for (size_t source = begin; source < end; ++source) {
+      dominators_from(g, (uint32_t)source, table.idom.data() + source * n, mine);
+    }
+  });
+}
+
+// Closability checks put to dominator tables across the process, and how many they settled.
+// Searches count into their SearchContext and are added here once per piece of a run.
+struct DominatorStats {
+  std::atomic<uint64_t> checks;
+  std::atomic<uint64_t> rejections;
+  
+  DominatorStats(): checks(0), rejections(0) {}
+  
+  template<typename TContext>
+  void collect(TContext& context) {
+    checks += context.dominator_checks;
+    rejections += context.dominator_rejections;
+    context.dominator_checks = 0;
+    context.dominator_rejections = 0;
+  }
+};
+
+inline DominatorStats& dominator_stats() {
+  static DominatorStats stats;
+  return stats;
+}
+
+inline void report_dominator_stats(const std::string& label) {
+  const uint64_t checks = dominator_stats().checks;
+  if (checks == 0) return;
+  const uint64_t rejections = dominator_stats().rejections;
+  std::cout << label << "Dominators settled " << rejections << " of " << checks << " closability checks ("
+            << 100.0 * rejections / checks << "%) without a search" << std::endl;
+}
+
+#endif /* DominatorTable_h */
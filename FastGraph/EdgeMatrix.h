@@ -0,0 +1,47 @@
+//
+//  EdgeMatrix.h
+//  FastGraph
+//
+//  Created by culter on 10/18/26.
+//  Copyright © 2026 culter. All rights reserved.
+//
+
+#ifndef EdgeMatrix_h
+#define EdgeMatrix_h
+
+#include <cstdint>
+#include <vector>
+
+// One successor bit row per node, sized to the graph rather than to a size class:
+// 704 nodes take 88 bytes a row, about 62 KB in all.
+struct EdgeMatrix {
+  size_t row_words;
+  std::vector<uint64_t> succ_rows;
+
+  EdgeMatrix(): row_words(0) {}
+
+  bool empty() const { return succ_rows.empty(); }
+  size_t size() const { return row_words ? succ_rows.size() / row_words : 0; }
+
+  const uint64_t* succ_row(size_t v) const { return succ_rows.data() + v * row_words; }
+
+  bool has_edge(size_t v, size_t w) const { return (succ_row(v)[w >> 6] >> (w & 63)) & 1; }
+};
+
+// Builds g.edge_matrix from g's neighbor lists. Anything that renumbers or removes nodes
+// must clear the matrix, as relabel, compact and remove_node do; has_edge then scans again.
+// Its size alone cannot tell that a same-size renumbering has made it stale.
+template<typename TGraph>
+void index_edges(TGraph& g) {
+  EdgeMatrix& matrix = g.edge_matrix;
+  const size_t n = g.nodes.size();
+  matrix.row_words = (n + 63) / 64;
+  matrix.succ_rows.assign(n * matrix.row_words, 0);
+  for (size_t v = 0; v < n; ++v) {
+    for (auto w = g.nodes[v].succ_cbegin(); w != g.nodes[v].succ_cend(); ++w) {
+      matrix.succ_rows[v * matrix.row_words + (*w >> 6)] |= uint64_t(1) << (*w & 63);
+    }
+  }
+}
+
+#endif /* EdgeMatrix_h */
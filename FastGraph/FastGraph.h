@@ -9,12 +9,46 @@
 #ifndef FastGraph_h
 #define FastGraph_h
 
+#include <algorithm>
+#include <cstdint>
+#include <string>
 #include <vector>
 
+#include "DominatorTable.h"
+#include "EdgeMatrix.h"
+
 template<typename TNode>
 struct FastGraph {
+  typedef typename TNode::index_type index_type;
+  
   std::vector<TNode> nodes;
   std::vector<std::string> names;
+  // Index of each node in the graph as it was first loaded, before any nodes were removed.
+  std::vector<uint32_t> original_ids;
+  // How many input nodes each node stands for after chain contraction. Empty means one each.
+  std::vector<uint32_t> weights;
+  
+  // Optional O(1) edge tests; filled in by index_edges.
+  EdgeMatrix edge_matrix;
+  // Optional proof that a path is cut off; filled in by index_dominators.
+  DominatorTable dominators;
+  
+  // Scans v's successors unless there is an edge matrix. Whatever renumbers nodes clears it,
+  // so a matrix of the right size is current.
+  bool has_edge(size_t v, size_t w) const {
+    if (edge_matrix.size() == nodes.size()) return edge_matrix.has_edge(v, w);
+    return std::find(nodes[v].succ_cbegin(), nodes[v].succ_cend(), w) != nodes[v].succ_cend();
+  }
+  
+  // Cleared with the edge matrix, so a table of the right size is current.
+  bool has_dominators() const { return !dominators.empty() && dominators.size() == nodes.size(); }
+  
+  size_t weight(size_t i) const { return weights.empty() ? 1 : weights[i]; }
+  size_t total_weight() const {
+    size_t answer = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) answer += weight(i);
+    return answer;
+  }
   
   void check() const {
     for (const auto& n: nodes) {
@@ -38,7 +72,9 @@ FastGraph<Node<TIndex, TDegree, MaxDegree>> cycle(int length) {
   FastGraph<Node<TIndex, TDegree, MaxDegree>> answer;
   answer.nodes.resize(length);
   answer.names.resize(length);
+  answer.original_ids.resize(length);
   for (int i = 0; i < length; ++i) {
+    answer.original_ids[i] = i;
     answer.nodes[i].succ_push((i + 1) % length);
     answer.nodes[i].pred_push((i + length - 1) % length);
   }
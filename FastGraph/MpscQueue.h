@@ -0,0 +1,60 @@
+//
+//  MpscQueue.h
+//  FastGraph
+//
+//  Created by culter on 10/18/26.
+//  Copyright © 2026 culter. All rights reserved.
+//
+
+#ifndef MpscQueue_h
+#define MpscQueue_h
+
+#include <atomic>
+#include <utility>
+
+// Unbounded queue for many producers and one consumer, without locks (Vyukov's design).
+// push is one atomic exchange plus a store; pop touches only the consumer's end.
+// A pop racing a push may miss that value until the next pop, but never loses it.
+template<typename T>
+class MpscQueue {
+  struct Cell {
+    std::atomic<Cell*> next;
+    T value;
+    Cell(): next(nullptr) {}
+  };
+
+  // Producers append after head; the consumer reads after tail, a cell it already consumed.
+  std::atomic<Cell*> head;
+  Cell* tail;
+
+public:
+  MpscQueue(): head(new Cell), tail(head.load()) {}
+
+  ~MpscQueue() {
+    T discard;
+    while (pop(discard)) {}
+    delete tail;
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  void push(T value) {
+    Cell* cell = new Cell;
+    cell->value = std::move(value);
+    Cell* previous = head.exchange(cell, std::memory_order_acq_rel);
+    previous->next.store(cell, std::memory_order_release);
+  }
+
+  // Consumer only.
+  bool pop(T& out) {
+    Cell* next = tail->next.load(std::memory_order_acquire);
+    if (!next) return false;
+    out = std::move(next->value);
+    delete tail;
+    tail = next;
+    return true;
+  }
+};
+
+#endif /* MpscQueue_h */
@@ -21,6 +21,9 @@ class alignas(16) Node {
   std::array<TIndex, MaxDegree> neighbors;
   
 public:
+  typedef TIndex index_type;
+  static constexpr size_t max_degree = MaxDegree;
+  
   Node(): out_degree(0), in_degree(0), neighbors{} {}
   
   constexpr const TDegree get_out_degree() const { return out_degree; }
@@ -9,23 +9,212 @@
 #ifndef NodeSet_h
 #define NodeSet_h
 
-// Next multiple of 64 greater than 671
-constexpr static const uint16_t MaxNodes = 704;
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
 
-// Two bytes per slot seems to be the fastest, at least in the tests I've run.
-// It's also faster than std::bitset<MaxNodes>.
-typedef uint16_t NodeSet[MaxNodes];
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
-template<typename InputIterator>
-void flatten(NodeSet& out, InputIterator begin, InputIterator end) {
+#include "Config.h"
+
+// Node-count size classes. The search code is compiled once per class, and evolve picks the
+// smallest class that holds the graph, so small graphs keep L1-sized sets and fringes.
+constexpr static const size_t k_size_classes[] = {256, 1024, 4096, 16384};
+// The largest graph any size class holds.
+constexpr static const size_t MaxNodes = k_size_classes[3];
+
+// Word-wide kernels over arrays of 64-bit words.
+// Callers always pass a multiple of 4 words, so the AVX2 loops never need a scalar tail.
+
+inline void bits_clear(uint64_t* a, size_t words) {
+#if defined(__AVX2__)
+  const __m256i zero = _mm256_setzero_si256();
+  for (size_t i = 0; i < words; i += 4) {
+    _mm256_storeu_si256((__m256i*)(a + i), zero);
+  }
+#elif defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (size_t i = 0; i < words; i += 2) {
+    _mm_storeu_si128((__m128i*)(a + i), zero);
+  }
+#else
+  memset(a, 0, words * sizeof(uint64_t));
+#endif
+}
+
+// a |= b
+inline void bits_or(uint64_t* a, const uint64_t* b, size_t words) {
+#if defined(__AVX2__)
+  for (size_t i = 0; i < words; i += 4) {
+    __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+    __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+    _mm256_storeu_si256((__m256i*)(a + i), _mm256_or_si256(va, vb));
+  }
+#elif defined(__SSE2__)
+  for (size_t i = 0; i < words; i += 2) {
+    __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+    _mm_storeu_si128((__m128i*)(a + i), _mm_or_si128(va, vb));
+  }
+#else
+  for (size_t i = 0; i < words; ++i) a[i] |= b[i];
+#endif
+}
+
+// a &= ~b
+inline void bits_andnot(uint64_t* a, const uint64_t* b, size_t words) {
+#if defined(__AVX2__)
+  for (size_t i = 0; i < words; i += 4) {
+    __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+    __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+    _mm256_storeu_si256((__m256i*)(a + i), _mm256_andnot_si256(vb, va));
+  }
+#elif defined(__SSE2__)
+  for (size_t i = 0; i < words; i += 2) {
+    __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+    _mm_storeu_si128((__m128i*)(a + i), _mm_andnot_si128(vb, va));
+  }
+#else
+  for (size_t i = 0; i < words; ++i) a[i] &= ~b[i];
+#endif
+}
+
+// (a & b) != 0
+inline bool bits_intersect(const uint64_t* a, const uint64_t* b, size_t words) {
+#if defined(__AVX2__)
+  __m256i acc = _mm256_setzero_si256();
+  for (size_t i = 0; i < words; i += 4) {
+    __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+    __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+    acc = _mm256_or_si256(acc, _mm256_and_si256(va, vb));
+  }
+  return !_mm256_testz_si256(acc, acc);
+#elif defined(__SSE2__)
+  __m128i acc = _mm_setzero_si128();
+  for (size_t i = 0; i < words; i += 2) {
+    __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+    acc = _mm_or_si128(acc, _mm_and_si128(va, vb));
+  }
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) != 0xFFFF;
+#else
+  uint64_t acc = 0;
+  for (size_t i = 0; i < words; ++i) acc |= a[i] & b[i];
+  return acc != 0;
+#endif
+}
+
+inline size_t bits_popcount(const uint64_t* a, size_t words) {
+#if defined(__AVX2__)
+  // Nibble lookup (Mula): popcount each byte with pshufb, then sum bytes with psadbw.
+  const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                          0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_mask = _mm256_set1_epi8(0x0f);
+  __m256i acc = _mm256_setzero_si256();
+  for (size_t i = 0; i < words; i += 4) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)(a + i));
+    __m256i lo = _mm256_and_si256(v, low_mask);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+  }
+  return (size_t)(_mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) +
+                  _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3));
+#else
+  // Without AVX2 the scalar popcnt instruction beats any SSE emulation.
+  size_t count = 0;
+  for (size_t i = 0; i < words; ++i) count += __builtin_popcountll(a[i]);
+  return count;
+#endif
+}
+
+// Original layout: two bytes per slot.
+// This was the fastest in the tests I ran against std::bitset<MaxNodes>.
+// Kept so that claim can be re-checked against BitNodeSet on new hardware.
+template<size_t Capacity>
+struct SlotNodeSet {
+  constexpr static const size_t capacity = Capacity;
+  uint16_t slots[Capacity];
+
+  bool operator[](size_t i) const { return slots[i]; }
+  void set(size_t i) { slots[i] = true; }
+  void reset(size_t i) { slots[i] = false; }
+  void clear() { memset(slots, 0, sizeof(slots)); }
+
+  void unite(const SlotNodeSet& other) {
+    for (size_t i = 0; i < Capacity; ++i) slots[i] |= other.slots[i];
+  }
+  void subtract(const SlotNodeSet& other) {
+    for (size_t i = 0; i < Capacity; ++i) slots[i] &= ~other.slots[i];
+  }
+  bool intersects(const SlotNodeSet& other) const {
+    for (size_t i = 0; i < Capacity; ++i) {
+      if (slots[i] & other.slots[i]) return true;
+    }
+    return false;
+  }
+  size_t count() const {
+    size_t answer = 0;
+    for (size_t i = 0; i < Capacity; ++i) answer += (slots[i] != 0);
+    return answer;
+  }
+
+  template<typename F>
+  void for_each(F f) const {
+    for (size_t i = 0; i < Capacity; ++i) {
+      if (slots[i]) f(i);
+    }
+  }
+};
+
+// One bit per node, padded to whole AVX2 registers.
+template<size_t Capacity>
+struct BitNodeSet {
+  constexpr static const size_t capacity = Capacity;
+  constexpr static const size_t word_count = (Capacity + 255) / 256 * 4;
+  uint64_t words[word_count];
+
+  bool operator[](size_t i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+  void set(size_t i) { words[i >> 6] |= uint64_t(1) << (i & 63); }
+  void reset(size_t i) { words[i >> 6] &= ~(uint64_t(1) << (i & 63)); }
+  void clear() { bits_clear(words, word_count); }
+
+  void unite(const BitNodeSet& other) { bits_or(words, other.words, word_count); }
+  void subtract(const BitNodeSet& other) { bits_andnot(words, other.words, word_count); }
+  bool intersects(const BitNodeSet& other) const { return bits_intersect(words, other.words, word_count); }
+  size_t count() const { return bits_popcount(words, word_count); }
+
+  template<typename F>
+  void for_each(F f) const {
+    for (size_t w = 0; w < word_count; ++w) {
+      for (uint64_t bits = words[w]; bits; bits &= bits - 1) {
+        f(w * 64 + __builtin_ctzll(bits));
+      }
+    }
+  }
+};
+
+template<size_t Capacity>
+using NodeSetOf = typename std::conditional<k_bit_packed_node_sets, BitNodeSet<Capacity>, SlotNodeSet<Capacity>>::type;
+
+// Big enough for any graph. Code that has a SearchContext uses the context's size class instead.
+typedef NodeSetOf<MaxNodes> NodeSet;
+
+template<typename TSet, typename InputIterator>
+void flatten(TSet& out, InputIterator begin, InputIterator end) {
   for (auto in = begin; in != end; ++in) {
-    out[*in] = true;
+    out.set(*in);
   }
 }
 
-void print(const NodeSet& node_set) {
-  std::cout << "NodeSet {array_size=" << MaxNodes << "; nonzero=[";
-  for (uint16_t i = 0; i < MaxNodes; ++i) {
+template<typename TSet>
+void print_node_set(const TSet& node_set) {
+  std::cout << "NodeSet {array_size=" << (size_t)TSet::capacity << "; nonzero=[";
+  for (size_t i = 0; i < TSet::capacity; ++i) {
     if (node_set[i]) {
       std::cout << i << ",";
     }
@@ -33,4 +222,9 @@ void print(const NodeSet& node_set) {
   std::cout << "]}";
 }
 
+template<size_t Capacity>
+void print(const SlotNodeSet<Capacity>& node_set) { print_node_set(node_set); }
+template<size_t Capacity>
+void print(const BitNodeSet<Capacity>& node_set) { print_node_set(node_set); }
+
 #endif /* NodeSet_h */
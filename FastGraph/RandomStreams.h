@@ -0,0 +1,40 @@
+//
+//  RandomStreams.h
+//  FastGraph
+//
+//  Created by culter on 10/18/26.
+//  Copyright © 2026 culter. All rights reserved.
+//
+
+#ifndef RandomStreams_h
+#define RandomStreams_h
+
+#include <cstdint>
+
+// SplitMix64: one add and three multiply-xorshifts per draw, and seeding is free, so every
+// site and gene of a generation can have its own stream. Works with the std distributions
+// and std::shuffle.
+struct SplitMix64 {
+  typedef uint64_t result_type;
+  uint64_t state;
+
+  explicit SplitMix64(uint64_t seed): state(seed) {}
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return UINT64_MAX; }
+
+  result_type operator()() {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+};
+
+// Stream number index of the family named by base. Neighboring indices give unrelated streams.
+inline SplitMix64 random_stream(uint64_t base, uint64_t index) {
+  SplitMix64 mix(base ^ (index * 0xd1b54a32d192ed03ULL));
+  return SplitMix64(mix());
+}
+
+#endif /* RandomStreams_h */
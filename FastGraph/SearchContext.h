@@ -0,0 +1,71 @@
+//
+//  SearchContext.h
+//  FastGraph
+//
+//  Created by culter on 10/18/26.
+//  Copyright © 2026 culter. All rights reserved.
+//
+
+#ifndef SearchContext_h
+#define SearchContext_h
+
+#include <algorithm>
+#include <vector>
+
+#include "NodeSet.h"
+
+// Scratch space for graph searches, owned by one thread and reused for every call.
+// Visited marks are generation stamps: a node is in the forward body iff
+// forward_stamp[v] == epoch, so starting a new search is one increment instead of a memset.
+// Capacity is the size class: the largest node count this context's NodeSets can hold.
+template<typename TIndex, size_t Capacity = MaxNodes>
+struct SearchContext {
+  typedef NodeSetOf<Capacity> NodeSet;
+  constexpr static const size_t capacity = Capacity;
+  
+  std::vector<uint32_t> forward_stamp;
+  std::vector<uint32_t> reverse_stamp;
+  uint32_t epoch;
+
+  std::vector<TIndex> forward_fringe;
+  std::vector<TIndex> reverse_fringe;
+  std::vector<TIndex> this_level;
+
+  // Used by mutate_dfs, and candidates by mutate_faster and mutate_better
+  std::vector<TIndex> to_explore;
+  std::vector<TIndex> candidates;
+
+  // Closability checks the graph's dominator table saw, and how many it answered no.
+  uint64_t dominator_checks;
+  uint64_t dominator_rejections;
+
+  explicit SearchContext(size_t node_count = Capacity)
+  : forward_stamp(node_count, 0), reverse_stamp(node_count, 0), epoch(0),
+    dominator_checks(0), dominator_rejections(0) {
+    forward_fringe.reserve(node_count);
+    reverse_fringe.reserve(node_count);
+    this_level.reserve(node_count);
+    to_explore.reserve(node_count);
+    candidates.reserve(node_count);
+  }
+
+  // Forget every mark from the previous search.
+  void begin_search() {
+    ++epoch;
+    if (epoch == 0) {
+      // Wrapped around after 2^32 searches; stale stamps could now collide.
+      std::fill(forward_stamp.begin(), forward_stamp.end(), 0);
+      std::fill(reverse_stamp.begin(), reverse_stamp.end(), 0);
+      epoch = 1;
+    }
+    forward_fringe.clear();
+    reverse_fringe.clear();
+  }
+
+  bool in_forward_body(TIndex v) const { return forward_stamp[v] == epoch; }
+  bool in_reverse_body(TIndex v) const { return reverse_stamp[v] == epoch; }
+  void add_to_forward_body(TIndex v) { forward_stamp[v] = epoch; }
+  void add_to_reverse_body(TIndex v) { reverse_stamp[v] = epoch; }
+};
+
+#endif /* SearchContext_h */
@@ -0,0 +1,208 @@
+//
+//  SharedRing.h
+//  FastGraph
+//
+//  Created by culter on 10/18/26.
+//  Copyright © 2026 culter. All rights reserved.
+//
+
+#ifndef SharedRing_h
+#define SharedRing_h
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Gene.h"
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "SharedRing needs address-free 64-bit atomics");
+
+// Identifies a search graph by its size and successor lists, so that only processes searching
+// the same graph with the same numbering share a ring.
+template<typename TGraph>
+uint64_t graph_fingerprint(const TGraph& g) {
+  uint64_t hash = 14695981039346656037ULL;
+  auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * 1099511628211ULL; };
+  mix(g.nodes.size());
+  for (size_t v = 0; v < g.nodes.size(); ++v) {
+    mix(g.nodes[v].get_out_degree());
+    for (auto w = g.nodes[v].succ_cbegin(); w != g.nodes[v].succ_cend(); ++w) {
+      mix(*w);
+    }
+  }
+  return hash;
+}
+
+// A broadcast ring of genes in POSIX shared memory, for islands in separate processes.
+// Writers claim ticket t with one fetch_add and fill slot t % slot_count; every reader keeps its
+// own cursor and sees every gene written since it attached, until writers lap it. Nothing
+// registers or waits, so processes can join, leave or crash at any time. Slots are guarded
+// seqlock style: sequence is 2t + 1 while ticket t is written and 2t + 2 once it is complete.
+class SharedRing {
+public:
+  constexpr static const uint32_t slot_count = 256;
+
+private:
+  constexpr static const uint64_t k_ready = 0x464752494e47ULL; // "FGRING"
+
+  // Header and slots start on their own cache lines, so no atomic straddles one.
+  struct alignas(64) Header {
+    std::atomic<uint64_t> ready;
+    uint64_t fingerprint;
+    uint32_t node_count;
+    uint32_t slot_count;
+    std::atomic<uint64_t> head;
+  };
+
+  struct Slot {
+    std::atomic<uint64_t> sequence;
+    uint32_t origin;
+    uint32_t length;
+    // Followed by node_count uint32_t path entries.
+  };
+
+  void* base;
+  size_t bytes;
+  uint32_t node_count;
+
+  Header& header() const { return *static_cast<Header*>(base); }
+  size_t slot_bytes() const { return (sizeof(Slot) + node_count * sizeof(uint32_t) + 63) / 64 * 64; }
+  Slot& slot(uint64_t ticket) const {
+    char* first = static_cast<char*>(base) + sizeof(Header);
+    return *reinterpret_cast<Slot*>(first + (ticket % slot_count) * slot_bytes());
+  }
+  uint32_t* path(Slot& s) const { return reinterpret_cast<uint32_t*>(&s + 1); }
+
+public:
+  SharedRing(): base(nullptr), bytes(0), node_count(0) {}
+  ~SharedRing() {
+    if (base) munmap(base, bytes);
+  }
+  SharedRing(const SharedRing&) = delete;
+  SharedRing& operator=(const SharedRing&) = delete;
+
+  bool is_open() const { return base != nullptr; }
+
+  // Creates the ring called name, or attaches to the one another process created.
+  // Fails, with a message, if that ring was made for a different graph.
+  bool open(const std::string& name, uint64_t fingerprint, uint32_t nodes) {
+    node_count = nodes;
+    bytes = sizeof(Header) + slot_count * slot_bytes();
+    bool created = true;
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+      created = false;
+      fd = shm_open(name.c_str(), O_RDWR, 0600);
+    }
+    if (fd < 0) {
+      std::cout << "Could not open shared memory " << name << std::endl;
+      return false;
+    }
+    if (created && ftruncate(fd, bytes) != 0) {
+      std::cout << "Could not size shared memory " << name << std::endl;
+      close(fd);
+      shm_unlink(name.c_str());
+      return false;
+    }
+    // The creator may not have sized it yet.
+    struct stat info;
+    for (int tries = 0; fstat(fd, &info) == 0 && (size_t)info.st_size < bytes && tries < 100; ++tries) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size != bytes) {
+      std::cout << "Shared memory " << name << " has the wrong size for this graph" << std::endl;
+      close(fd);
+      return false;
+    }
+    base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+      base = nullptr;
+      std::cout << "Could not map shared memory " << name << std::endl;
+      return false;
+    }
+
+    Header& h = header();
+    if (created) {
+      h.fingerprint = fingerprint;
+      h.node_count = nodes;
+      h.slot_count = slot_count;
+      h.head.store(0);
+      h.ready.store(k_ready, std::memory_order_release);
+    }
+    for (int tries = 0; h.ready.load(std::memory_order_acquire) != k_ready && tries < 100; ++tries) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (h.ready.load(std::memory_order_acquire) != k_ready ||
+        h.fingerprint != fingerprint || h.node_count != nodes || h.slot_count != slot_count) {
+      std::cout << "Shared memory " << name << " belongs to a different graph" << std::endl;
+      munmap(base, bytes);
+      base = nullptr;
+      return false;
+    }
+    return true;
+  }
+
+  uint64_t head() const { return header().head.load(std::memory_order_acquire); }
+
+  template<typename TIndex>
+  void publish(uint32_t origin, const Gene<TIndex>& gene) {
+    if (gene.path.size() > node_count) return;
+    const uint64_t ticket = header().head.fetch_add(1, std::memory_order_acq_rel);
+    Slot& s = slot(ticket);
+    s.sequence.store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s.origin = origin;
+    s.length = (uint32_t)gene.path.size();
+    uint32_t* out = path(s);
+    for (size_t i = 0; i < gene.path.size(); ++i) out[i] = gene.path[i];
+    s.sequence.store(2 * ticket + 2, std::memory_order_release);
+  }
+
+  // Appends to out the genes written from cursor up to the head, except those from origin,
+  // keeping at most the newest limit. Returns the cursor for next time. A slot still being
+  // written stops the scan, unless writers have since lapped it, as after a crash.
+  template<typename TIndex>
+  uint64_t collect(uint64_t cursor, uint32_t origin, size_t limit, std::vector<Gene<TIndex>>& out) {
+    const uint64_t end = head();
+    if (end > cursor + slot_count) cursor = end - slot_count;
+    std::vector<Gene<TIndex>> found;
+    for (; cursor < end; ++cursor) {
+      Slot& s = slot(cursor);
+      const uint64_t before = s.sequence.load(std::memory_order_acquire);
+      if (before < 2 * cursor + 2) {
+        if (end - cursor < slot_count / 2) break;
+        continue;
+      }
+      if (before != 2 * cursor + 2 || s.origin == origin || s.length > node_count) continue;
+      Gene<TIndex> gene;
+      gene.path.resize(s.length);
+      const uint32_t* in = path(s);
+      // Check each entry before narrowing it to TIndex, where 300 would pass as 44.
+      bool in_range = true;
+      for (size_t i = 0; i < gene.path.size(); ++i) {
+        const uint32_t v = in[i];
+        in_range &= v < node_count;
+        gene.path[i] = (TIndex)v;
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (s.sequence.load(std::memory_order_relaxed) != before || !in_range) continue;
+      found.push_back(std::move(gene));
+    }
+    const size_t skip = found.size() > limit ? found.size() - limit : 0;
+    for (size_t i = skip; i < found.size(); ++i) out.push_back(std::move(found[i]));
+    return cursor;
+  }
+};
+
+#endif /* SharedRing_h */
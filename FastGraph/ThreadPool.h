@@ -0,0 +1,228 @@
+//
+//  ThreadPool.h
+//  FastGraph
+//
+//  Created by culter on 10/18/26.
+//  Copyright © 2026 culter. All rights reserved.
+//
+
+#ifndef ThreadPool_h
+#define ThreadPool_h
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent workers, each with its own task deque.
+// A task submitted from a worker goes on that worker's deque, which it drains newest first,
+// so a task's follow-up work stays on the same core while it is warm. Idle workers take
+// tasks submitted from outside first, then steal the oldest task from another worker.
+class ThreadPool {
+  struct Worker {
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+  };
+
+  std::vector<std::unique_ptr<Worker>> queues;
+  std::vector<std::thread> workers;
+  std::deque<std::function<void()>> injected;
+  std::mutex mutex;
+  std::condition_variable progress;
+  // Tasks queued but not yet taken, and tasks running.
+  std::atomic<size_t> pending;
+  std::atomic<size_t> busy;
+  bool stopping;
+
+  // Which worker of which pool the calling thread is, if any.
+  static ThreadPool*& current_pool() { static thread_local ThreadPool* pool = nullptr; return pool; }
+  static size_t& current_worker() { static thread_local size_t worker = 0; return worker; }
+
+  bool take(size_t self, std::function<void()>& task) {
+    {
+      std::lock_guard<std::mutex> lock(queues[self]->mutex);
+      if (!queues[self]->tasks.empty()) {
+        task = std::move(queues[self]->tasks.back());
+        queues[self]->tasks.pop_back();
+        return true;
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!injected.empty()) {
+        task = std::move(injected.front());
+        injected.pop_front();
+        return true;
+      }
+    }
+    for (size_t i = 1; i <= queues.size(); ++i) {
+      Worker& victim = *queues[(self + i) % queues.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void run(std::function<void()>& task) {
+    busy += 1;
+    pending -= 1;
+    task();
+    busy -= 1;
+    { std::lock_guard<std::mutex> lock(mutex); }
+    progress.notify_all();
+  }
+
+  void work(size_t self) {
+    current_pool() = this;
+    current_worker() = self;
+    while (true) {
+      std::function<void()> task;
+      if (take(self, task)) {
+        run(task);
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(mutex);
+      progress.wait(lock, [this]{ return stopping || pending > 0; });
+      if (stopping && pending == 0) return;
+    }
+  }
+
+public:
+  explicit ThreadPool(unsigned threads): pending(0), busy(0), stopping(false) {
+    if (threads < 1) threads = 1;
+    for (unsigned i = 0; i < threads; ++i) {
+      queues.emplace_back(new Worker);
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+      workers.emplace_back([this, i]{ work(i); });
+    }
+  }
+
+  // Runs every task already submitted, then joins the workers.
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    progress.notify_all();
+    for (auto& worker: workers) {
+      worker.join();
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  size_t size() const { return workers.size(); }
+
+  // The calling thread's worker number, or size() for a thread outside the pool.
+  size_t worker_index() const { return current_pool() == this ? current_worker() : workers.size(); }
+
+  void submit(std::function<void()> task) {
+    pending += 1;
+    if (current_pool() == this) {
+      Worker& own = *queues[current_worker()];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      own.tasks.push_back(std::move(task));
+    } else {
+      std::lock_guard<std::mutex> lock(mutex);
+      injected.push_back(std::move(task));
+    }
+    // Taking mutex orders this against a worker that has just found nothing to do.
+    { std::lock_guard<std::mutex> lock(mutex); }
+    progress.notify_one();
+  }
+
+  // Queues task behind everything submitted from outside the pool, even from a worker,
+  // so a task that resubmits itself takes turns with its peers instead of running on.
+  void defer(std::function<void()> task) {
+    pending += 1;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      injected.push_back(std::move(task));
+    }
+    progress.notify_one();
+  }
+
+  // Blocks until done() holds, which is rechecked whenever a task finishes.
+  // A worker runs tasks while it waits, so a task can wait on tasks it submitted. Other
+  // threads just sleep, which keeps the machine at one running thread per worker.
+  void wait_until(const std::function<bool()>& done) {
+    const bool helping = current_pool() == this;
+    while (!done()) {
+      std::function<void()> task;
+      if (helping && take(current_worker(), task)) {
+        run(task);
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(mutex);
+      // The timeout covers a done() that flips without a task finishing.
+      progress.wait_for(lock, std::chrono::milliseconds(10), [&]{ return (helping && pending > 0) || done(); });
+    }
+  }
+
+  // Blocks until done() holds without running any task, for a caller whose own work is
+  // already claimed and must not be held up by an unrelated task.
+  void sleep_until(const std::function<bool()>& done) {
+    while (!done()) {
+      std::unique_lock<std::mutex> lock(mutex);
+      // The timeout covers a done() that flips without a task finishing.
+      progress.wait_for(lock, std::chrono::milliseconds(10), done);
+    }
+  }
+
+  // Blocks until the queues are empty and no task is running. Not for use inside a task.
+  void wait_idle() {
+    wait_until([this]{ return busy == 0 && pending == 0; });
+  }
+};
+
+// Calls body(begin, end) on consecutive pieces of [0, count), a few per worker, and returns
+// once every piece is done. Which piece runs where varies, so body must not depend on it.
+// Pieces are claimed from a counter, so the caller works through its own batch and then only
+// sleeps; it never picks up another task, such as another island's step, while it waits.
+template<typename TBody>
+void parallel_for(ThreadPool& pool, size_t count, TBody body) {
+  const size_t pieces = std::min(count, 4 * pool.size());
+  if (pieces <= 1) {
+    if (count) body(size_t(0), count);
+    return;
+  }
+  // Helpers may be taken after the caller has returned; they find nothing left to claim
+  // and touch only this shared state, never body.
+  struct Batch {
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> finished{0};
+  };
+  auto batch = std::make_shared<Batch>();
+  const auto drain = [count, pieces](Batch& batch, TBody& body) {
+    for (size_t i; (i = batch.next++) < pieces; ) {
+      body(count * i / pieces, count * (i + 1) / pieces);
+      batch.finished += 1;
+    }
+  };
+  TBody* shared_body = &body;
+  for (size_t i = 1; i < pieces; ++i) {
+    pool.submit([batch, shared_body, drain]{ drain(*batch, *shared_body); });
+  }
+  drain(*batch, body);
+  pool.sleep_until([&batch, pieces]{ return batch->finished == pieces; });
+}
+
+// One pool for the whole process, with a worker per hardware thread.
+inline ThreadPool& shared_pool() {
+  static ThreadPool pool(std::thread::hardware_concurrency());
+  return pool;
+}
+
+#endif /* ThreadPool_h */
@@ -0,0 +1,100 @@
+//
+//  dispatch.h
+//  FastGraph
+//
+//  Created by culter on 10/18/26.
+//  Copyright © 2026 culter. All rights reserved.
+//
+
+#ifndef dispatch_h
+#define dispatch_h
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "Config.h"
+#include "FastGraph.h"
+#include "Node.h"
+#include "evolution.h"
+
+// Graphs are loaded and prepared in this layout, which fits any node with up to 31 neighbors.
+typedef Node<uint16_t, uint8_t, 31> InputNode;
+
+// In plus out neighbors of the busiest node.
+template<typename TGraph>
+size_t max_degree(const TGraph& g) {
+  size_t answer = 0;
+  for (size_t v = 0; v < g.nodes.size(); ++v) {
+    answer = std::max<size_t>(answer, g.nodes[v].get_out_degree() + g.nodes[v].get_in_degree());
+  }
+  return answer;
+}
+
+// The same graph in another Node layout. Node ids and neighbor order are unchanged,
+// so the search makes exactly the same moves on either copy.
+template<typename TNode, typename TGraph>
+FastGraph<TNode> convert_nodes(const TGraph& g) {
+  FastGraph<TNode> answer;
+  answer.nodes.resize(g.nodes.size());
+  for (size_t v = 0; v < g.nodes.size(); ++v) {
+    for (auto w = g.nodes[v].succ_cbegin(); w != g.nodes[v].succ_cend(); ++w) {
+      answer.nodes[v].succ_push(*w);
+    }
+    for (auto w = g.nodes[v].pred_cbegin(); w != g.nodes[v].pred_cend(); ++w) {
+      answer.nodes[v].pred_push(*w);
+    }
+  }
+  answer.names = g.names;
+  answer.original_ids = g.original_ids;
+  answer.weights = g.weights;
+  answer.edge_matrix = g.edge_matrix;
+  answer.dominators = g.dominators;
+  return answer;
+}
+
+template<typename TNode, typename TGraph, typename TRun>
+void run_as(const std::vector<TGraph>& parts, TRun run) {
+  std::vector<FastGraph<TNode>> converted;
+  converted.reserve(parts.size());
+  for (const auto& part: parts) {
+    converted.push_back(convert_nodes<TNode>(part));
+  }
+  std::cout << "Searching with " << sizeof(typename TNode::index_type) << "-byte indices and "
+            << sizeof(TNode) << "-byte nodes" << std::endl;
+  run(converted);
+}
+
+// Runs run(parts) with the smallest precompiled Node layout that holds every part.
+// A uint8_t index needs at most 255 nodes, since mutate_dfs reserves TIndex(-1) as a marker.
+// Each layout fills a 16, 32 or 64 byte slot exactly, so alignas(16) adds no padding.
+template<typename TGraph, typename TRun>
+void with_tightest_nodes(const std::vector<TGraph>& parts, TRun run) {
+  size_t nodes = 0;
+  size_t degree = 0;
+  for (const auto& part: parts) {
+    nodes = std::max(nodes, part.nodes.size());
+    degree = std::max(degree, max_degree(part));
+  }
+
+  if (!k_tightest_node_types) run(parts);
+  else if (nodes <= 255 && degree <= 14) run_as<Node<uint8_t, uint8_t, 14>>(parts, run);
+  else if (nodes <= 255 && degree <= 30) run_as<Node<uint8_t, uint8_t, 30>>(parts, run);
+  else if (degree <= 7) run_as<Node<uint16_t, uint8_t, 7>>(parts, run);
+  else if (degree <= 15) run_as<Node<uint16_t, uint8_t, 15>>(parts, run);
+  else run(parts);
+}
+
+struct EvolveOne {
+  Record& record;
+  template<typename TGraph>
+  void operator()(const std::vector<TGraph>& parts) const { evolve(parts.front(), record, ""); }
+};
+
+struct EvolveComponents {
+  Record& record;
+  template<typename TGraph>
+  void operator()(const std::vector<TGraph>& parts) const { evolve_components(parts, record); }
+};
+
+#endif /* dispatch_h */
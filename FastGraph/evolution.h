@@ -9,34 +9,48 @@
 #ifndef evolution_h
 #define evolution_h
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <random>
-#include <thread>
+#include <string>
 
 #include "Config.h"
 #include "gene_operations.h"
 #include "graph_operations.h"
+#include "MpscQueue.h"
+#include "RandomStreams.h"
+#include "SearchContext.h"
+#include "SharedRing.h"
+#include "ThreadPool.h"
 
-template<typename TIndex, typename TDegree, size_t MaxDegree, typename TRng>
-void mutate(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
+template<typename TGraph, typename TIndex, size_t Capacity, typename TRng>
+void mutate(const TGraph& g,
             Gene<TIndex>& gene,
-            TRng& rng) {
+            TRng& rng,
+            SearchContext<TIndex, Capacity>& context) {
 //  while (true) {
     std::vector<TIndex> potential_additions;
     
     // TODO: This only adds forward. Also add backward at random.
     const TIndex i = gene.path.back();
-    NodeSet flat = {};
+    NodeSetOf<Capacity> flat = {};
     flatten(flat, gene.path.cbegin() + 1, gene.path.cend());
     for (auto pj = g.nodes[i].succ_cbegin(); pj != g.nodes[i].succ_cend(); ++pj) {
       if (*pj != gene.path.front() && !flat[*pj]) {
-        if (has_path(g, *pj, gene.path.front(), flat)) {
+        if (has_path(g, *pj, gene.path.front(), flat, context)) {
           potential_additions.push_back(*pj);
         }
       }
     }
     if (!potential_additions.empty()) {
-      std::uniform_int_distribution<TIndex> chooser(0, potential_additions.size() - 1);
+      std::uniform_int_distribution<size_t> chooser(0, potential_additions.size() - 1);
       gene.path.push_back(potential_additions[chooser(rng)]);
     }
     else {
@@ -45,68 +59,74 @@ void mutate(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
 //  }
 }
 
-template<typename TIndex, typename TDegree, size_t MaxDegree, typename TRng>
-void mutate_faster(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
+template<typename TGraph, typename TIndex, size_t Capacity, typename TRng>
+void mutate_faster(const TGraph& g,
                    Gene<TIndex>& gene,
-                   TRng& rng) {
+                   TRng& rng,
+                   SearchContext<TIndex, Capacity>& context) {
   // TODO: This only adds forward. Also add backward at random.
   const TIndex i = gene.path.back();
-  std::vector<TIndex> successors_shuffled(g.nodes[i].succ_cbegin(), g.nodes[i].succ_cend());
+  std::vector<TIndex>& successors_shuffled = context.candidates;
+  successors_shuffled.assign(g.nodes[i].succ_cbegin(), g.nodes[i].succ_cend());
   std::shuffle(successors_shuffled.begin(), successors_shuffled.end(), rng);
   
-  NodeSet flat = {};
+  NodeSetOf<Capacity> flat = {};
   flatten(flat, gene.path.cbegin() + 1, gene.path.cend());
-  for (const TIndex& j: successors_shuffled) {
-    if (j != gene.path.front() && !flat[j]) {
-      if (has_path(g, j, gene.path.front(), flat)) {
-        gene.path.push_back(j);
-        return;
-      }
-    }
+  const TIndex front = gene.path.front();
+  successors_shuffled.erase(std::remove_if(successors_shuffled.begin(), successors_shuffled.end(),
+                                           [&](TIndex j) { return j == front || flat[j]; }),
+                            successors_shuffled.end());
+  const size_t chosen = first_connected<true>(g, front, successors_shuffled, flat, context);
+  if (chosen < successors_shuffled.size()) {
+    gene.path.push_back(successors_shuffled[chosen]);
   }
 }
 
-template<typename TIndex, typename TDegree, size_t MaxDegree, typename TRng>
-void mutate_better(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
+template<typename TGraph, typename TIndex, size_t Capacity, typename TRng>
+void mutate_better(const TGraph& g,
                    Gene<TIndex>& gene,
-                   TRng& rng) {
+                   TRng& rng,
+                   SearchContext<TIndex, Capacity>& context) {
   if (rng() % 2) {
     const TIndex i = gene.path.back();
-    std::vector<TIndex> candidates(g.nodes[i].succ_cbegin(), g.nodes[i].succ_cend());
+    std::vector<TIndex>& candidates = context.candidates;
+    candidates.assign(g.nodes[i].succ_cbegin(), g.nodes[i].succ_cend());
     std::shuffle(candidates.begin(), candidates.end(), rng);
     
-    NodeSet flat = {};
+    NodeSetOf<Capacity> flat = {};
     flatten(flat, gene.path.cbegin() + 1, gene.path.cend());
-    for (const TIndex& j: candidates) {
-      if (j != gene.path.front() && !flat[j]) {
-        if (has_path(g, j, gene.path.front(), flat)) {
-          gene.path.push_back(j);
-          return;
-        }
-      }
+    const TIndex front = gene.path.front();
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                    [&](TIndex j) { return j == front || flat[j]; }),
+                     candidates.end());
+    const size_t chosen = first_connected<true>(g, front, candidates, flat, context);
+    if (chosen < candidates.size()) {
+      gene.path.push_back(candidates[chosen]);
     }
   } else {
     const TIndex i = gene.path.front();
-    std::vector<TIndex> candidates(g.nodes[i].pred_cbegin(), g.nodes[i].pred_cend());
+    std::vector<TIndex>& candidates = context.candidates;
+    candidates.assign(g.nodes[i].pred_cbegin(), g.nodes[i].pred_cend());
     std::shuffle(candidates.begin(), candidates.end(), rng);
     
-    NodeSet flat = {};
+    NodeSetOf<Capacity> flat = {};
     flatten(flat, gene.path.cbegin(), gene.path.cend() - 1);
-    for (const TIndex& j: candidates) {
-      if (j != gene.path.back() && !flat[j]) {
-        if (has_path(g, gene.path.back(), j, flat)) {
-          gene.path.insert(gene.path.begin(), j);
-          return;
-        }
-      }
+    const TIndex back = gene.path.back();
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                    [&](TIndex j) { return j == back || flat[j]; }),
+                     candidates.end());
+    const size_t chosen = first_connected<false>(g, back, candidates, flat, context);
+    if (chosen < candidates.size()) {
+      gene.path.insert(gene.path.begin(), candidates[chosen]);
     }
   }
 }
 
-template<typename TIndex, typename TDegree, size_t MaxDegree, typename TRng>
-void mutate_dfs(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
+template<typename TGraph, typename TIndex, size_t Capacity, typename TRng>
+void mutate_dfs(const TGraph& g,
                 Gene<TIndex>& gene,
-                TRng& rng) {
+                TRng& rng,
+                SearchContext<TIndex, Capacity>& context) {
   constexpr TIndex marker = -1;
   
   if (gene.path.size() < 2) {
@@ -115,14 +135,15 @@ void mutate_dfs(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
   }
   
   // DFS traversal with random choices until a solution is found
-  NodeSet explored = {};
-  std::vector<TIndex> to_explore;
-  to_explore.reserve(MaxDegree);
-  std::vector<TIndex> temp;
-  temp.reserve(MaxDegree);
+  context.begin_search();
+  std::vector<TIndex>& to_explore = context.to_explore;
+  to_explore.clear();
+  std::vector<TIndex>& temp = context.candidates;
   
   // Explore forward
-  flatten(explored, gene.path.cbegin(), gene.path.cend() - 1);
+  for (auto in = gene.path.cbegin(); in != gene.path.cend() - 1; ++in) {
+    context.add_to_forward_body(*in);
+  }
   
   to_explore.push_back(gene.path.back());
   gene.path.pop_back();
@@ -138,8 +159,8 @@ void mutate_dfs(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
       // Success!
       return;
     }
-    else if (!explored[n]) {
-      explored[n] = true;
+    else if (!context.in_forward_body(n)) {
+      context.add_to_forward_body(n);
       
       gene.path.push_back(n);
       to_explore.push_back(marker);
@@ -155,7 +176,7 @@ void mutate_dfs(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
         if (*s == gene.path.front()) {
           hits_front = true;
         }
-        else if (!explored[*s]) {
+        else if (!context.in_forward_body(*s)) {
           temp.push_back(*s);
         }
       }
@@ -172,13 +193,14 @@ void mutate_dfs(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
   assert(false);
 }
 
-template<typename TIndex, typename TDegree, size_t MaxDegree, typename TRng>
-void optimize(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
+template<typename TGraph, typename TIndex, size_t Capacity, typename TRng>
+void optimize(const TGraph& g,
               Gene<TIndex>& gene,
-              TRng& rng) {
+              TRng& rng,
+              SearchContext<TIndex, Capacity>& context) {
   for (int tried = 0; tried < gene.path.size(); ++tried) {
     auto baseline_size = gene.path.size();
-    mutate_dfs(g, gene, rng);
+    mutate_dfs(g, gene, rng, context);
     if (gene.path.size() > baseline_size) {
       // Reset! We want to keep doing this until there are no more expansions.
       tried = 0;
@@ -187,48 +209,153 @@ void optimize(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
   }
 }
 
-template<typename TIndex, typename TDegree, size_t MaxDegree, typename TRng>
-void rotate(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
+template<typename TGraph, typename TIndex, typename TRng>
+void rotate(const TGraph& g,
             Gene<TIndex>& gene,
             TRng& rng) {
-  std::uniform_int_distribution<TIndex> rotor(0, gene.path.size() - 1);
+  std::uniform_int_distribution<size_t> rotor(0, gene.path.size() - 1);
   std::rotate(gene.path.begin(), gene.path.begin() + rotor(rng), gene.path.end());
 }
 
-template<typename TIndex, typename TDegree, size_t MaxDegree, typename TRng>
-std::vector<Gene<TIndex>> get_reversible_edges(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
-                                               TRng& rng) {
-  std::vector<Gene<TIndex>> population;
-  NodeSet empty = {};
+// Every edge i -> j that lies on a cycle, as a two-node gene, in edge order: the seeds every
+// island starts from. That is every edge inside a strongly connected component, so one pass
+// of Tarjan's algorithm answers what would otherwise be a has_path per edge. Nothing else
+// asks independent reachability questions in bulk: each of crossover's and mutation's
+// depends on the one before, so there is no batched multi-source search to feed.
+template<typename TGraph>
+std::vector<Gene<typename TGraph::index_type>> reversible_edges(const TGraph& g) {
+  typedef typename TGraph::index_type TIndex;
+  const Components components = strongly_connected_components(g);
+  std::vector<Gene<TIndex>> seeds;
   for (TIndex i = 0; i < g.nodes.size(); ++i) {
     for (auto pj = g.nodes[i].succ_cbegin(); pj != g.nodes[i].succ_cend(); ++pj) {
-      if (has_path(g, *pj, i, empty)) {
-        population.emplace_back();
-        population.back().path = std::vector<TIndex>{i, *pj};
-        
-        if (k_close_all_genes) {
-          mutate_dfs(g, population.back(), rng);
-        }
+      if (components.membership[*pj] == components.membership[i]) {
+        seeds.emplace_back();
+        seeds.back().path = std::vector<TIndex>{i, *pj};
       }
     }
   }
+  return seeds;
+}
+
+// A fresh population from the seeds, each closed into a cycle if k_close_all_genes.
+template<typename TGraph, typename TIndex, size_t Capacity, typename TRng>
+std::vector<Gene<TIndex>> seed_population(const TGraph& g,
+                                          const std::vector<Gene<TIndex>>& seeds,
+                                          TRng& rng,
+                                          SearchContext<TIndex, Capacity>& context) {
+  std::vector<Gene<TIndex>> population(seeds);
+  if (k_close_all_genes) {
+    for (auto& gene: population) {
+      mutate_dfs(g, gene, rng, context);
+    }
+  }
   return population;
 }
 
-template<typename TIndex>
+template<typename TGraph, typename TIndex, size_t Capacity, typename TRng>
+std::vector<Gene<TIndex>> get_reversible_edges(const TGraph& g,
+                                               TRng& rng,
+                                               SearchContext<TIndex, Capacity>& context) {
+  return seed_population(g, reversible_edges(g), rng, context);
+}
+
+// Which genes pass through each site, and where. The entries for site v run from first[v]
+// to first[v + 1]: genes[e] passes through v at offsets[e], in increasing gene order.
+// Rebuilt each generation by one counting pass over the population, into the same storage.
+struct SiteIndex {
+  std::vector<uint32_t> first;
+  std::vector<uint32_t> genes;
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> fill;
+  
+  bool empty(size_t site) const { return first[site] == first[site + 1]; }
+  uint32_t count(size_t site) const { return first[site + 1] - first[site]; }
+  
+  template<typename TIndex>
+  void build(const std::vector<Gene<TIndex>>& population, size_t node_count) {
+    first.assign(node_count + 1, 0);
+    for (const auto& gene: population) {
+      for (const TIndex site: gene.path) {
+        first[site + 1] += 1;
+      }
+    }
+    for (size_t site = 0; site < node_count; ++site) {
+      first[site + 1] += first[site];
+    }
+    genes.resize(first.back());
+    offsets.resize(first.back());
+    fill.assign(first.cbegin(), first.cend() - 1);
+    for (uint32_t igene = 0; igene < population.size(); ++igene) {
+      const std::vector<TIndex>& path = population[igene].path;
+      for (uint32_t offset = 0; offset < path.size(); ++offset) {
+        const uint32_t entry = fill[path[offset]]++;
+        genes[entry] = igene;
+        offsets[entry] = offset;
+      }
+    }
+  }
+};
+
+template<typename TIndex, size_t Capacity = MaxNodes>
 struct Evolver {
   std::mt19937 rng;
   std::vector<Gene<TIndex>> population;
   Gene<TIndex> longest;
   int age;
+  SearchContext<TIndex, Capacity> context;
+  // Scratch for each pool worker, plus one for the calling thread, when a generation is
+  // split across the pool. Created on first use.
+  std::vector<SearchContext<TIndex, Capacity>> worker_contexts;
+  // Two copies of each parent per worker, for rotating under k_close_all_genes.
+  std::vector<Gene<TIndex>> worker_parents;
+  // The generation before last. Crossover writes children over these genes and then swaps
+  // the buffers, so once paths have grown to size, generations allocate nothing.
+  std::vector<Gene<TIndex>> spare_population;
+  // The graph's reversible edges, if whoever runs this evolver has them cached.
+  const std::vector<Gene<TIndex>>* seeds = nullptr;
+  // Per-generation tables, kept so their storage is reused.
+  SiteIndex site_index;
+  std::vector<uint32_t> first_child;
 };
 
-template<typename TIndex>
-void merge(Evolver<TIndex>& target, Evolver<TIndex>& victim) {
-  target.population.insert(target.population.end(), victim.population.cbegin(), victim.population.cend());
+// Longest cycle found so far by any evolution in this process.
+struct Record {
+  std::atomic<size_t> length;
+  std::mutex mutex;
+  // Set when the search runs on a reduced graph: prints a record, given as the original_ids
+  // of its nodes, as the input-graph cycle it stands for.
+  std::function<void(const std::vector<uint32_t>&)> print_expanded;
+  
+  Record(): length(0) {}
+  
+  template<typename TGraph, typename TIndex>
+  void offer(const TGraph& g, const Gene<TIndex>& gene) {
+    const size_t weight = cycle_weight(g, gene);
+    if (weight <= length) return;
+    assert(is_path(g, gene));
+    std::lock_guard<std::mutex> lock(mutex);
+    if (weight <= length) return;
+    length = weight;
+    if (!k_print_records) return;
+    if (print_expanded) {
+      std::vector<uint32_t> cycle;
+      for (const TIndex v: gene.path) cycle.push_back(g.original_ids[v]);
+      print_expanded(cycle);
+    } else {
+      print(g, gene);
+    }
+  }
+};
+
+template<typename TGraph, typename TIndex, size_t Capacity>
+void merge(const TGraph& g, Evolver<TIndex, Capacity>& target, Evolver<TIndex, Capacity>& victim) {
+  target.population.insert(target.population.end(),
+                           std::make_move_iterator(victim.population.begin()),
+                           std::make_move_iterator(victim.population.end()));
   victim.population.clear();
   
-  if (victim.longest.path.size() > target.longest.path.size()) {
+  if (cycle_weight(g, victim.longest) > cycle_weight(g, target.longest)) {
     target.longest = victim.longest;
   }
   victim.longest.path.clear();
@@ -237,180 +364,586 @@ void merge(Evolver<TIndex>& target, Evolver<TIndex>& victim) {
   victim.age = 0;
 }
 
-template<typename TIndex, typename TDegree, size_t MaxDegree>
-void evolve(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
-            Evolver<TIndex>& evolver,
+// The mutation for one gene at this point in a run of max_generations.
+template<typename TGraph, typename TIndex, size_t Capacity, typename TRng>
+void mutate_for_generation(const TGraph& g,
+                           Gene<TIndex>& gene,
+                           TRng& rng,
+                           SearchContext<TIndex, Capacity>& context,
+                           uint32_t generation,
+                           uint32_t max_generations) {
+  if (generation <= max_generations * 0.95 + 10) {
+    if (k_close_all_genes) {
+      mutate_dfs(g, gene, rng, context);
+      rotate(g, gene, rng);
+    }
+    else {
+      mutate_faster(g, gene, rng, context);
+    }
+  }
+  else if (generation <= max_generations * 0.99 + 10) {
+    if (k_close_after_one_third) {
+      mutate_dfs(g, gene, rng, context);
+      rotate(g, gene, rng);
+    }
+    else {
+      mutate_faster(g, gene, rng, context);
+    }
+  }
+  else {
+    if (k_optimize_after_two_thirds) {
+      optimize(g, gene, rng, context);
+      rotate(g, gene, rng);
+    }
+    else {
+      mutate_faster(g, gene, rng, context);
+    }
+  }
+}
+
+// One generation's crossover and mutation on the calling thread, all drawing from evolver.rng.
+template<typename TGraph, typename TIndex, size_t Capacity>
+void serial_generation(const TGraph& g,
+                       Evolver<TIndex, Capacity>& evolver,
+                       const SiteIndex& site_index,
+                       uint32_t generation,
+                       uint32_t max_generations) {
+  // Perform per-site crossover
+  {
+    std::vector<Gene<TIndex>>& next_population = evolver.spare_population;
+    size_t children = 0;
+    for (TIndex isite = 0; isite < g.nodes.size(); ++isite) {
+      if (!site_index.empty(isite)) {
+        // Pick from 0 to size - 1, inclusive
+        std::uniform_int_distribution<size_t> gene_chooser(0, site_index.count(isite) - 1);
+        
+        for (int x = 0; x < k_population_multiplier; ++x) {
+          const uint32_t mother_entry = site_index.first[isite] + (uint32_t)gene_chooser(evolver.rng);
+          const uint32_t father_entry = site_index.first[isite] + (uint32_t)gene_chooser(evolver.rng);
+          Gene<TIndex>& mother = evolver.population[site_index.genes[mother_entry]];
+          Gene<TIndex>& father = evolver.population[site_index.genes[father_entry]];
+          
+          //          auto test1 = cross_reference(g, isite, mother, father);
+          //          auto test2 = cross_faster(g, isite, mother, father, evolver.context);
+          //
+          //          assert(test1.path.size() == test2.path.size());
+          //          for (int i = 0; i < test1.path.size(); ++i) {
+          //            assert(test1.path[i] == test2.path[i]);
+          //          }
+          
+          size_t mother_offset = site_index.offsets[mother_entry];
+          size_t father_offset = site_index.offsets[father_entry];
+          if (k_close_all_genes) {
+            // Rotating in place moves the site, and the index has no record of it.
+            rotate(g, mother, evolver.rng);
+            rotate(g, father, evolver.rng);
+            mother_offset = std::find(mother.path.cbegin(), mother.path.cend(), isite) - mother.path.cbegin();
+            father_offset = std::find(father.path.cbegin(), father.path.cend(), isite) - father.path.cbegin();
+          }
+          
+          if (children == next_population.size()) next_population.emplace_back();
+          cross_faster(g, isite, mother, mother_offset, father, father_offset, evolver.context, next_population[children++]);
+        }
+      }
+    }
+    next_population.resize(children);
+    evolver.population.swap(next_population);
+  }
+  
+  // Perform mutations
+  for (auto& gene: evolver.population) {
+    mutate_for_generation(g, gene, evolver.rng, evolver.context, generation, max_generations);
+  }
+}
+
+// One generation's crossover and mutation, split across the shared pool. Each site and each
+// gene draws from its own stream, seeded from evolver.rng once per generation, so the result
+// is the same however the work is divided, including on one thread. Unlike the serial loop,
+// rotating parents under k_close_all_genes rotates copies, so sites cannot see each other.
+template<typename TGraph, typename TIndex, size_t Capacity>
+void parallel_generation(const TGraph& g,
+                         Evolver<TIndex, Capacity>& evolver,
+                         const SiteIndex& site_index,
+                         uint32_t generation,
+                         uint32_t max_generations) {
+  ThreadPool& pool = shared_pool();
+  if (evolver.worker_contexts.size() != pool.size() + 1) {
+    evolver.worker_contexts.assign(pool.size() + 1, SearchContext<TIndex, Capacity>(g.nodes.size()));
+  }
+  // Each draw gets its own statement; the operands of | may be evaluated in either order.
+  const uint64_t cross_high = evolver.rng();
+  const uint64_t cross_low = evolver.rng();
+  const uint64_t mutate_high = evolver.rng();
+  const uint64_t mutate_low = evolver.rng();
+  const uint64_t cross_seed = (cross_high << 32) | cross_low;
+  const uint64_t mutate_seed = (mutate_high << 32) | mutate_low;
+  
+  // Children of each site go to a fixed place in the next population.
+  std::vector<uint32_t>& first_child = evolver.first_child;
+  first_child.assign(g.nodes.size() + 1, 0);
+  for (size_t isite = 0; isite < g.nodes.size(); ++isite) {
+    first_child[isite + 1] = first_child[isite] + (site_index.empty(isite) ? 0 : k_population_multiplier);
+  }
+  std::vector<Gene<TIndex>>& next_population = evolver.spare_population;
+  next_population.resize(first_child.back());
+  if (k_close_all_genes) {
+    evolver.worker_parents.resize(2 * evolver.worker_contexts.size());
+  }
+  
+  const std::vector<Gene<TIndex>>& population = evolver.population;
+  parallel_for(pool, g.nodes.size(), [&](size_t begin, size_t end) {
+    const size_t worker = pool.worker_index();
+    SearchContext<TIndex, Capacity>& context = evolver.worker_contexts[worker];
+    for (size_t isite = begin; isite < end; ++isite) {
+      if (site_index.empty(isite)) continue;
+      SplitMix64 rng = random_stream(cross_seed, isite);
+      std::uniform_int_distribution<size_t> gene_chooser(0, site_index.count(isite) - 1);
+      for (int x = 0; x < k_population_multiplier; ++x) {
+        const uint32_t mother_entry = site_index.first[isite] + (uint32_t)gene_chooser(rng);
+        const uint32_t father_entry = site_index.first[isite] + (uint32_t)gene_chooser(rng);
+        const Gene<TIndex>* mother = &population[site_index.genes[mother_entry]];
+        const Gene<TIndex>* father = &population[site_index.genes[father_entry]];
+        size_t mother_offset = site_index.offsets[mother_entry];
+        size_t father_offset = site_index.offsets[father_entry];
+        if (k_close_all_genes) {
+          Gene<TIndex>& rotated_mother = evolver.worker_parents[2 * worker];
+          Gene<TIndex>& rotated_father = evolver.worker_parents[2 * worker + 1];
+          rotated_mother.path.assign(mother->path.cbegin(), mother->path.cend());
+          rotated_father.path.assign(father->path.cbegin(), father->path.cend());
+          rotate(g, rotated_mother, rng);
+          rotate(g, rotated_father, rng);
+          mother = &rotated_mother;
+          father = &rotated_father;
+          mother_offset = std::find(mother->path.cbegin(), mother->path.cend(), isite) - mother->path.cbegin();
+          father_offset = std::find(father->path.cbegin(), father->path.cend(), isite) - father->path.cbegin();
+        }
+        cross_faster(g, (TIndex)isite, *mother, mother_offset, *father, father_offset, context,
+                     next_population[first_child[isite] + x]);
+      }
+    }
+  });
+  evolver.population.swap(next_population);
+  
+  parallel_for(pool, evolver.population.size(), [&](size_t begin, size_t end) {
+    SearchContext<TIndex, Capacity>& context = evolver.worker_contexts[pool.worker_index()];
+    for (size_t igene = begin; igene < end; ++igene) {
+      SplitMix64 rng = random_stream(mutate_seed, igene);
+      mutate_for_generation(g, evolver.population[igene], rng, context, generation, max_generations);
+    }
+  });
+}
+
+// Generations first through last of a run of max_generations. The mutation schedule
+// depends on max_generations, so a run split into pieces matches the run in one go.
+template<typename TGraph, typename TIndex, size_t Capacity>
+void evolve(const TGraph& g,
+            Evolver<TIndex, Capacity>& evolver,
+            uint32_t first_generation,
+            uint32_t last_generation,
             uint32_t max_generations) {
-  for (uint32_t generation = 1; generation <= max_generations; ++generation) {
+  for (uint32_t generation = first_generation; generation <= last_generation; ++generation) {
     evolver.age += 1;
     
     // Refresh gene pool
     for (int y = 0; y < k_refresh_edge_count; ++y) {
-      auto refresh = get_reversible_edges(g, evolver.rng);
+      auto refresh = evolver.seeds ? seed_population(g, *evolver.seeds, evolver.rng, evolver.context)
+                                   : get_reversible_edges(g, evolver.rng, evolver.context);
       evolver.population.insert(evolver.population.end(), refresh.cbegin(), refresh.cend());
     }
     
     // Don't mind me, just testing the optimize() function...
 //    std::cout << "Before optimization: ";
 //    print(g, evolver.population[0]);
-//    optimize(g, evolver.population[0], evolver.rng);
+//    optimize(g, evolver.population[0], evolver.rng, evolver.context);
 //    std::cout << "After optimization: ";
 //    print(g, evolver.population[0]);
 //    exit(0);
     
-    // Pre-compute which sites are touched by which genes
-    std::vector<std::vector<TIndex>> site_to_gene_pool(g.nodes.size());
-    for (int igene = 0; igene < evolver.population.size(); ++igene) {
-      for (const TIndex isite: evolver.population[igene].path) {
-        site_to_gene_pool[isite].push_back(igene);
-      }
-    }
+    // Pre-compute which sites are touched by which genes, and where
+    // Gene numbers can outgrow TIndex when TIndex is uint8_t, so they get their own type.
+    evolver.site_index.build(evolver.population, g.nodes.size());
     
-    // Perform per-site crossover
-    {
-      std::vector<Gene<TIndex>> next_population;
-      for (TIndex isite = 0; isite < g.nodes.size(); ++isite) {
-        const std::vector<TIndex>& candidates = site_to_gene_pool[isite];
-        if (!candidates.empty()) {
-          // Pick from 0 to size - 1, inclusive
-          std::uniform_int_distribution<TIndex> gene_chooser(0, candidates.size() - 1);
-          
-          for (int x = 0; x < k_population_multiplier; ++x) {
-            Gene<TIndex>& mother = evolver.population[candidates[gene_chooser(evolver.rng)]];
-            Gene<TIndex>& father = evolver.population[candidates[gene_chooser(evolver.rng)]];
-            
-            //          auto test1 = cross_reference(g, isite, mother, father);
-            //          auto test2 = cross_faster(g, isite, mother, father);
-            //
-            //          assert(test1.path.size() == test2.path.size());
-            //          for (int i = 0; i < test1.path.size(); ++i) {
-            //            assert(test1.path[i] == test2.path[i]);
-            //          }
-            
-            if (k_close_all_genes) {
-              rotate(g, mother, evolver.rng);
-              rotate(g, father, evolver.rng);
-            }
-            
-            next_population.push_back(cross_faster(g, isite, mother, father));
-          }
-        }
-      }
-      evolver.population = std::move(next_population);
+    if (k_parallel_generations) {
+      parallel_generation(g, evolver, evolver.site_index, generation, max_generations);
     }
-    
-    // Perform mutations
-    for (auto& gene: evolver.population) {
-      if (generation <= max_generations * 0.95 + 10) {
-        if (k_close_all_genes) {
-          mutate_dfs(g, gene, evolver.rng);
-          rotate(g, gene, evolver.rng);
-        }
-        else {
-          mutate_faster(g, gene, evolver.rng);
-        }
-      }
-      else if (generation <= max_generations * 0.99 + 10) {
-        if (k_close_after_one_third) {
-          mutate_dfs(g, gene, evolver.rng);
-          rotate(g, gene, evolver.rng);
-        }
-        else {
-          mutate_faster(g, gene, evolver.rng);
-        }
-      }
-      else {
-        if (k_optimize_after_two_thirds) {
-          optimize(g, gene, evolver.rng);
-          rotate(g, gene, evolver.rng);
-        }
-        else {
-          mutate_faster(g, gene, evolver.rng);
-        }
-      }
+    else {
+      serial_generation(g, evolver, evolver.site_index, generation, max_generations);
     }
     
     // Record keeping
     for (const auto& gene: evolver.population) {
-      if (gene.path.size() > evolver.longest.path.size()) {
+      if (cycle_weight(g, gene) > cycle_weight(g, evolver.longest)) {
         evolver.longest = gene;
       }
     }
   }
+  
+  dominator_stats().collect(evolver.context);
+  for (auto& context: evolver.worker_contexts) {
+    dominator_stats().collect(context);
+  }
+}
+
+template<typename TGraph, typename TIndex, size_t Capacity>
+void evolve(const TGraph& g,
+            Evolver<TIndex, Capacity>& evolver,
+            uint32_t max_generations) {
+  evolve(g, evolver, 1, max_generations, max_generations);
 }
 
-template<typename TIndex, typename TDegree, size_t MaxDegree>
-void evolve_single(FastGraph<Node<TIndex, TDegree, MaxDegree>>& g) {
+template<typename TGraph>
+void evolve_single(TGraph& g) {
+  typedef typename TGraph::index_type TIndex;
   Evolver<TIndex> evolver;
   evolver.rng.seed(k_random_seed);
   
   if (k_refresh_edge_count < 1) {
-    evolver.population = get_reversible_edges(g, evolver.rng);
+    evolver.population = get_reversible_edges(g, evolver.rng, evolver.context);
   }
   
   size_t record = 0;
   for (uint32_t generation = 0; generation < k_max_generations; generation += k_report_record_period) {
     evolve(g, evolver, k_report_record_period);
-    if (evolver.longest.path.size() > record) {
+    if (cycle_weight(g, evolver.longest) > record) {
       if (k_print_records) print(g, evolver.longest);
-      record = evolver.longest.path.size();
+      record = cycle_weight(g, evolver.longest);
     }
     std::cout << "Generation " << generation << ": best length " << record << std::endl;
+    report_dominator_stats("");
   }
 }
 
-template<typename TIndex, typename TDegree, size_t MaxDegree>
-void evolve(FastGraph<Node<TIndex, TDegree, MaxDegree>>& g) {
-  Evolver<TIndex> evolvers[num_evolvers];
-  for (int i = 0; i < num_evolvers; ++i) {
-    evolvers[i].rng.seed(k_random_seed + i);
-    evolvers[i].age = 0;
+// Island epoch e runs (e + 1) * k_report_record_period generations.
+inline uint32_t epoch_length(uint32_t epoch) {
+  return (epoch + 1) * (uint32_t)k_report_record_period;
+}
+
+inline uint64_t generations_before_epoch(uint32_t epoch) {
+  return (uint64_t)k_report_record_period * epoch * (epoch + 1) / 2;
+}
+
+// Copies of the k_migrants longest genes in the population.
+template<typename TGraph, typename TIndex>
+std::vector<Gene<TIndex>> emigrants(const TGraph& g, const std::vector<Gene<TIndex>>& population) {
+  std::vector<std::pair<size_t, uint32_t>> ranked;
+  ranked.reserve(population.size());
+  for (uint32_t i = 0; i < population.size(); ++i) {
+    ranked.emplace_back(cycle_weight(g, population[i]), i);
+  }
+  const size_t count = std::min<size_t>(k_migrants, ranked.size());
+  std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+                    [](const std::pair<size_t, uint32_t>& a, const std::pair<size_t, uint32_t>& b) {
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+  });
+  std::vector<Gene<TIndex>> answer;
+  for (size_t i = 0; i < count; ++i) {
+    answer.push_back(population[ranked[i].second]);
   }
+  return answer;
+}
 
-  if (k_refresh_edge_count < 1) {
-    for (auto& evolver: evolvers) {
-      evolver.population = get_reversible_edges(g, evolver.rng);
+// Island model without pairwise merges. Each island runs its epochs on its own, in pieces of
+// k_report_record_period generations. After each piece it pushes copies of its best genes
+// into the inboxes of its two neighbors on a ring, and before each piece it adds whatever
+// has arrived in its own inbox to its population. Nothing waits for anything, so a slow
+// island never holds up a fast one; in exchange, which migrants arrive when depends on
+// thread timing, and runs do not repeat exactly.
+// With Migration::shared the ring is a SharedRing instead: each island broadcasts to every
+// island of every process on the host and takes up to 2 * k_migrants of the newest arrivals.
+template<size_t Capacity, typename TGraph>
+void evolve_migrating_islands(const TGraph& g,
+                              Record& record,
+                              const std::string& label) {
+  typedef typename TGraph::index_type TIndex;
+  ThreadPool& pool = shared_pool();
+  std::vector<Evolver<TIndex, Capacity>> islands(num_evolvers);
+  std::vector<std::unique_ptr<MpscQueue<Gene<TIndex>>>> inboxes;
+  
+  // Across processes, islands differ by process id, and a gene's origin names its island.
+  SharedRing ring;
+  std::vector<uint64_t> cursors(num_evolvers);
+  const uint32_t process = k_migration == Migration::shared ? (uint32_t)getpid() : 0;
+  if (k_migration == Migration::shared) {
+    const uint64_t fingerprint = graph_fingerprint(g);
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)fingerprint);
+    if (ring.open(k_shared_ring_name + std::string(hex), fingerprint, (uint32_t)g.nodes.size())) {
+      std::fill(cursors.begin(), cursors.end(), ring.head());
+    } else {
+      std::cout << label << "Migrating within this process only" << std::endl;
     }
   }
+  auto origin = [process](int island) { return process * 256 + (uint32_t)island; };
   
-  size_t record = 0;
-  uint32_t generation = 0;
-  for (int multiplier = 1; generation <= k_max_generations; ++multiplier) {
-    uint32_t generations_this_epoch = multiplier * k_report_record_period;
-    generation += generations_this_epoch;
-    std::vector<std::thread> threads;
-    for (auto& evolver: evolvers) {
-      threads.emplace_back([&]{ evolve(g, evolver, generations_this_epoch); });
+  // Computed once; each island copies them, and closes its copies itself, when it starts.
+  const std::vector<Gene<TIndex>> seeds = reversible_edges(g);
+  for (int i = 0; i < num_evolvers; ++i) {
+    islands[i].rng.seed(k_random_seed + i + process * num_evolvers);
+    islands[i].age = 0;
+    islands[i].seeds = &seeds;
+    inboxes.emplace_back(new MpscQueue<Gene<TIndex>>);
+  }
+  
+  std::mutex mutex;
+  std::vector<int> finished_in_epoch;
+  size_t best = 0;
+  std::atomic<bool> stop(false);
+  std::atomic<int> active(num_evolvers);
+  
+  std::function<void(int, uint32_t, uint32_t)> step = [&](int island, uint32_t epoch, uint32_t done) {
+    Evolver<TIndex, Capacity>& evolver = islands[island];
+    if (stop || generations_before_epoch(epoch) > k_max_generations) {
+      active -= 1;
+      return;
     }
-    for (auto& thread: threads) {
-      thread.join();
+    if (epoch == 0 && done == 0 && k_refresh_edge_count < 1) {
+      evolver.population = seed_population(g, *evolver.seeds, evolver.rng, evolver.context);
     }
+    Gene<TIndex> immigrant;
+    while (inboxes[island]->pop(immigrant)) {
+      evolver.population.push_back(std::move(immigrant));
+    }
+    if (ring.is_open()) {
+      // Another process's genes are only as good as its memory, so check them.
+      std::vector<Gene<TIndex>> arrivals;
+      cursors[island] = ring.collect(cursors[island], origin(island), 2 * k_migrants, arrivals);
+      for (auto& gene: arrivals) {
+        if (!gene.path.empty() && is_path(g, gene) && has_path(g, gene.path, evolver.context)) {
+          evolver.population.push_back(std::move(gene));
+        }
+      }
+    }
+    
+    const uint32_t length = epoch_length(epoch);
+    const uint32_t last = std::min<uint32_t>(done + k_report_record_period, length);
+    evolve(g, evolver, done + 1, last, length);
     
-    for (auto& evolver: evolvers) {
-      if (evolver.longest.path.size() > record) {
-        if (k_print_records) print(g, evolver.longest);
-        record = evolver.longest.path.size();
+    if (ring.is_open()) {
+      for (auto& gene: emigrants(g, evolver.population)) {
+        ring.publish(origin(island), gene);
+      }
+    } else {
+      for (const int neighbor: {(island + 1) % num_evolvers, (island + num_evolvers - 1) % num_evolvers}) {
+        if (neighbor == island) continue;
+        for (auto& gene: emigrants(g, evolver.population)) {
+          inboxes[neighbor]->push(std::move(gene));
+        }
       }
     }
+    record.offer(g, evolver.longest);
     
-    std::cout << "Generation " << generation << ": best length " << record << std::endl;
+    if (last == length) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (finished_in_epoch.size() <= epoch) finished_in_epoch.resize(epoch + 1, 0);
+      best = std::max(best, cycle_weight(g, evolver.longest));
+      finished_in_epoch[epoch] += 1;
+      if (finished_in_epoch[epoch] == num_evolvers) {
+        std::lock_guard<std::mutex> lock(record.mutex);
+        std::cout << label << "Generation " << generations_before_epoch(epoch + 1) << ": best length " << best << std::endl;
+        report_dominator_stats(label);
+      }
+    }
+    if (g.total_weight() <= record.length && !stop.exchange(true)) {
+      std::lock_guard<std::mutex> lock(record.mutex);
+      std::cout << label << "Stopping: " << g.total_weight() << " nodes cannot beat length " << record.length << std::endl;
+    }
     
-    // Shuffle!
-    for (int i = 0; 2*i+1 < num_evolvers; ++i) {
-//      std::cout << "Merging " << 2*i+1 << " to " << 2*i << std::endl;
-      merge(evolvers[2*i], evolvers[2*i+1]);
-      if (k_refresh_edge_count < 1) {
-        evolvers[2*i+1].population = get_reversible_edges(g, evolvers[2*i+1].rng);
+    // Deferred, so islands sharing a worker take turns and their migrants keep flowing.
+    if (last < length) {
+      pool.defer([&step, island, epoch, last]{ step(island, epoch, last); });
+    } else {
+      pool.defer([&step, island, epoch]{ step(island, epoch + 1, 0); });
+    }
+  };
+  
+  for (int i = 0; i < num_evolvers; ++i) {
+    pool.submit([&step, i]{ step(i, 0, 0); });
+  }
+  pool.wait_until([&]{ return active == 0; });
+}
+
+// Island model on one graph, run as tasks on the shared pool. Each epoch of an island is
+// submitted k_report_record_period generations at a time, so idle workers can steal the
+// rest. Islands pair up by slot after each epoch: the second of a pair to finish merges the
+// two and starts both on their next epoch, while other pairs carry on. Slot 2i keeps the
+// merged pair, slot 2i+1 restarts from the reversible edges, and then the slots are shuffled
+// so islands meet new partners. Who meets whom is fixed in advance, so results do not depend
+// on thread timing. Stops once the graph is too small to beat the shared record.
+template<size_t Capacity, typename TGraph>
+void evolve_islands(const TGraph& g,
+                    Record& record,
+                    const std::string& label) {
+  if (k_migration != Migration::merge) {
+    evolve_migrating_islands<Capacity>(g, record, label);
+    return;
+  }
+  typedef typename TGraph::index_type TIndex;
+  ThreadPool& pool = shared_pool();
+  // Computed once; each island copies them, and closes its copies itself, when it starts
+  // out or has just been merged away.
+  const std::vector<Gene<TIndex>> seeds = reversible_edges(g);
+  std::vector<Evolver<TIndex, Capacity>> islands(num_evolvers);
+  for (int i = 0; i < num_evolvers; ++i) {
+    islands[i].rng.seed(k_random_seed + i);
+    islands[i].age = 0;
+    islands[i].seeds = &seeds;
+  }
+  
+  // slot_after[s]: where the island in slot s goes for the next epoch.
+  std::vector<int> slot_before(num_evolvers);
+  for (int i = 0; i < num_evolvers; ++i) slot_before[i] = i;
+  for (int i = 1; 2*i < num_evolvers; ++i) std::swap(slot_before[i], slot_before[2*i]);
+  std::vector<int> slot_after(num_evolvers);
+  for (int i = 0; i < num_evolvers; ++i) slot_after[slot_before[i]] = i;
+  
+  std::mutex mutex;
+  // First island of each (epoch, pair) to finish, waiting for the other.
+  std::map<std::pair<uint32_t, int>, int> waiting;
+  std::vector<int> finished_in_epoch;
+  size_t best = 0;
+  std::atomic<bool> stop(false);
+  // Islands running or queued; parked islands do not count.
+  std::atomic<int> active(num_evolvers);
+  
+  std::function<void(int, int, uint32_t, uint32_t)> step;
+  
+  auto start_epoch = [&](int island, int slot, uint32_t epoch) {
+    if (stop || generations_before_epoch(epoch) > k_max_generations) {
+      active -= 1;
+      return;
+    }
+    pool.submit([&step, island, slot, epoch]{ step(island, slot, epoch, 0); });
+  };
+  
+  // Both islands of a pair have finished epoch; island_a is in the even slot.
+  auto meet = [&](int island_a, int island_b, int slot_a, uint32_t epoch) {
+    const uint32_t generation = (uint32_t)generations_before_epoch(epoch + 1);
+    record.offer(g, islands[island_a].longest);
+    if (island_b >= 0) record.offer(g, islands[island_b].longest);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (finished_in_epoch.size() <= epoch) finished_in_epoch.resize(epoch + 1, 0);
+      best = std::max(best, cycle_weight(g, islands[island_a].longest));
+      if (island_b >= 0) best = std::max(best, cycle_weight(g, islands[island_b].longest));
+      finished_in_epoch[epoch] += island_b >= 0 ? 2 : 1;
+      if (finished_in_epoch[epoch] == num_evolvers) {
+        std::lock_guard<std::mutex> lock(record.mutex);
+        std::cout << label << "Generation " << generation << ": best length " << best << std::endl;
+        report_dominator_stats(label);
       }
     }
-    for (int i = 1; 2*i < num_evolvers; ++i) {
-//      std::cout << "Swapping " << i << " with " << 2*i << std::endl;
-      std::swap(evolvers[i], evolvers[2*i]);
+    
+    if (g.total_weight() <= record.length && !stop.exchange(true)) {
+      std::lock_guard<std::mutex> lock(record.mutex);
+      std::cout << label << "Stopping: " << g.total_weight() << " nodes cannot beat length " << record.length << std::endl;
+    }
+    
+    if (island_b >= 0) {
+      merge(g, islands[island_a], islands[island_b]);
+      active += 1;
+      start_epoch(island_b, slot_after[slot_a + 1], epoch + 1);
+    }
+    start_epoch(island_a, slot_after[slot_a], epoch + 1);
+  };
+  
+  step = [&](int island, int slot, uint32_t epoch, uint32_t done) {
+    Evolver<TIndex, Capacity>& evolver = islands[island];
+    if (stop) {
+      active -= 1;
+      return;
+    }
+    if (done == 0 && evolver.population.empty() && k_refresh_edge_count < 1) {
+      evolver.population = seed_population(g, *evolver.seeds, evolver.rng, evolver.context);
+    }
+    const uint32_t length = epoch_length(epoch);
+    const uint32_t last = std::min<uint32_t>(done + k_report_record_period, length);
+    evolve(g, evolver, done + 1, last, length);
+    if (last < length) {
+      pool.submit([&step, island, slot, epoch, last]{ step(island, slot, epoch, last); });
+      return;
+    }
+    
+    const int partner_slot = slot ^ 1;
+    if (partner_slot >= num_evolvers) {
+      meet(island, -1, slot, epoch);
+      return;
     }
-    for (int i = 0; i < num_evolvers; ++i) {
-//      std::cout << "Pool " << i << " has " << evolvers[i].population.size() << " genes" << std::endl;
+    int partner = -1;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto key = std::make_pair(epoch, slot / 2);
+      auto found = waiting.find(key);
+      if (found == waiting.end()) {
+        waiting[key] = island;
+      } else {
+        partner = found->second;
+        waiting.erase(found);
+      }
     }
+    if (partner < 0) {
+      // Parked. Once active reaches 0 the caller returns and everything captured here is
+      // gone, so the decrement comes after the lock is released and is the last thing done.
+      active -= 1;
+      return;
+    }
+    if (slot % 2 == 0) meet(island, partner, slot, epoch);
+    else meet(partner, island, partner_slot, epoch);
+  };
+  
+  for (int i = 0; i < num_evolvers; ++i) {
+    pool.submit([&step, i]{ step(i, i, 0, 0); });
+  }
+  pool.wait_until([&]{ return active == 0; });
+}
+
+// Size class i, or the smallest class if TIndex cannot count that high.
+// The branch for such a class is never taken, and this way it is never compiled either.
+template<typename TIndex>
+constexpr size_t size_class(size_t i) {
+  return k_size_classes[i] <= size_t(std::numeric_limits<TIndex>::max()) + 1 ? k_size_classes[i] : k_size_classes[0];
+}
+
+// Runs the island model in the smallest size class that holds g.
+template<typename TGraph>
+void evolve(const TGraph& g,
+            Record& record,
+            const std::string& label) {
+  typedef typename TGraph::index_type TIndex;
+  const size_t n = g.nodes.size();
+  if (n <= k_size_classes[0]) evolve_islands<size_class<TIndex>(0)>(g, record, label);
+  else if (n <= k_size_classes[1]) evolve_islands<size_class<TIndex>(1)>(g, record, label);
+  else if (n <= k_size_classes[2]) evolve_islands<size_class<TIndex>(2)>(g, record, label);
+  else if (n <= k_size_classes[3]) evolve_islands<size_class<TIndex>(3)>(g, record, label);
+  else {
+    std::lock_guard<std::mutex> lock(record.mutex);
+    std::cout << label << n << " nodes is more than the largest size class, " << MaxNodes << std::endl;
+  }
+}
+
+template<typename TGraph>
+void evolve(const TGraph& g) {
+  Record record;
+  evolve(g, record, "");
+}
+
+// Searches every component on one pool, largest first. Each component gives up
+// as soon as its input node count is no longer above the best cycle found anywhere.
+template<typename TGraph>
+void evolve_components(const std::vector<TGraph>& components, Record& record) {
+  ThreadPool& pool = shared_pool();
+  for (size_t c = 0; c < components.size(); ++c) {
+    pool.submit([&, c]{
+      const auto& g = components[c];
+      const std::string label = "[Component " + std::to_string(c) + ", " + std::to_string(g.total_weight()) + " nodes] ";
+      if (g.total_weight() <= record.length) {
+        std::lock_guard<std::mutex> lock(record.mutex);
+        std::cout << label << "Skipped: cannot beat length " << record.length << std::endl;
+        return;
+      }
+      evolve(g, record, label);
+    });
   }
+  pool.wait_idle();
 }
 
 #endif /* evolution_h */
@@ -9,15 +9,17 @@
 #ifndef gene_operations_h
 #define gene_operations_h
 
+#include <cstring>
 #include <iostream>
 #include <unordered_set>
 
 #include "NodeSet.h"
 #include "Gene.h"
 #include "graph_operations.h"
+#include "SearchContext.h"
 
-template<typename TIndex, typename TDegree, size_t MaxDegree>
-Gene<TIndex> cross_reference(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
+template<typename TGraph, typename TIndex>
+Gene<TIndex> cross_reference(const TGraph& g,
                              TIndex site,
                              const Gene<TIndex>& mother,
                              const Gene<TIndex>& father) {
@@ -64,8 +66,8 @@ Gene<TIndex> cross_reference(const FastGraph<Node<TIndex, TDegree, MaxDegree>>&
   return child;
 }
 
-template<typename TIndex, typename TDegree, size_t MaxDegree>
-Gene<TIndex> cross_2(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
+template<typename TGraph, typename TIndex>
+Gene<TIndex> cross_2(const TGraph& g,
                         TIndex site,
                         const Gene<TIndex>& mother,
                         const Gene<TIndex>& father) {
@@ -75,20 +77,20 @@ Gene<TIndex> cross_2(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
   auto m1 = m2;
   auto f2 = f1;
   NodeSet sa = {};
-  sa[site] = true;
+  sa.set(site);
   
   // Lengthen the shorter of m and f until the remainders are equal
   int mother_more_room = (int)(m1 - mother.path.cbegin()) - (int)(father.path.cend() - f2);
   while (mother_more_room < 0) {
     assert(f2 != father.path.cend());
-    sa[*f2] = true;
+    sa.set(*f2);
     f2++;
     mother_more_room++;
   }
   while (mother_more_room > 0) {
     assert(m1 != mother.path.cbegin());
     m1--;
-    sa[*m1] = true;
+    sa.set(*m1);
     mother_more_room--;
   }
   
@@ -98,8 +100,8 @@ Gene<TIndex> cross_2(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
     auto mn = *(m1 - 1);
     auto fn = *f2;
     if (mn == fn || sa[mn] || sa[fn]) break;
-    sa[mn] = true;
-    sa[fn] = true;
+    sa.set(mn);
+    sa.set(fn);
     m1--;
     f2++;
   }
@@ -113,6 +115,10 @@ Gene<TIndex> cross_2(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
   
 //  std::cout << "cross_2===========================================================================================" << std::endl;
   
+  // Each whittle frees the old ends, which lead into the new ones, so one search serves them all.
+  SearchContext<TIndex> context(g.nodes.size());
+  IncrementalReach<TGraph, NodeSet, MaxNodes> reach(g, sa, context);
+  
   // Whittle it down until it no longer self-intersects
   while (true) {
     child = m;
@@ -123,10 +129,17 @@ Gene<TIndex> cross_2(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
 //    std::cout << "f = " << f << std::endl;
 //    std::cout << "child = " << child << std::endl;
     
+    sa.reset(child.back());
+    sa.reset(child.front());
+    reach.release(child.back());
+    reach.release(child.front());
+    reach.add_source(child.back());
+    reach.add_target(child.front());
+    
     std::unordered_set<TIndex> nodes(child.cbegin(), child.cend());
     if (nodes.size() == child.size()) {
       // Hooray! Candidate does not repeat any nodes.
-      if (has_path(g, child)) {
+      if (reach.search()) {
         // Hooray! Path is closable.
         break;
       }
@@ -149,8 +162,8 @@ Gene<TIndex> cross_2(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
   return child;
 }
 
-template<typename TIndex, typename TDegree, size_t MaxDegree>
-Gene<TIndex> cross_fast(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
+template<typename TGraph, typename TIndex>
+Gene<TIndex> cross_fast(const TGraph& g,
                    TIndex site,
                    const Gene<TIndex>& mother,
                    const Gene<TIndex>& father) {
@@ -160,20 +173,20 @@ Gene<TIndex> cross_fast(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
   auto m1 = m2;
   auto f2 = f1;
   NodeSet sa = {};
-  sa[site] = true;
+  sa.set(site);
   
   // Lengthen the shorter of m and f until the remainders are equal
   int mother_more_room = (int)(m1 - mother.path.cbegin()) - (int)(father.path.cend() - f2);
   while (mother_more_room < 0) {
     assert(f2 != father.path.cend());
-    sa[*f2] = true;
+    sa.set(*f2);
     f2++;
     mother_more_room++;
   }
   while (mother_more_room > 0) {
     assert(m1 != mother.path.cbegin());
     m1--;
-    sa[*m1] = true;
+    sa.set(*m1);
     mother_more_room--;
   }
   
@@ -183,8 +196,8 @@ Gene<TIndex> cross_fast(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
     auto mn = *(m1 - 1);
     auto fn = *f2;
     if (mn == fn || sa[mn] || sa[fn]) break;
-    sa[mn] = true;
-    sa[fn] = true;
+    sa.set(mn);
+    sa.set(fn);
     m1--;
     f2++;
   }
@@ -192,71 +205,21 @@ Gene<TIndex> cross_fast(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
   // Now m + site + f is as long as possible without intersecting itself.
   // But we may need to shorten it again to be closable.
   
-  // Copy-paste job from has_path
+  // Shorten m and f together until the child closes, as in cross_faster.
   {
-    NodeSet forward_body = {};
-    NodeSet reverse_body = {};
-    TIndex forward_fringe[MaxNodes];
-    TIndex reverse_fringe[MaxNodes];
-    TIndex forward_fringe_size = 0;
-    TIndex reverse_fringe_size = 0;
-    
+    SearchContext<TIndex> context(g.nodes.size());
+    IncrementalReach<TGraph, NodeSet, MaxNodes> reach(g, sa, context);
     while (true) {
-      auto source = *(f2 - 1);
-      auto target = *m1;
-      auto& forbidden_nodes = sa;
-      
-      forbidden_nodes[source] = false;
-      forbidden_nodes[target] = false;
+      const TIndex source = *(f2 - 1);
+      const TIndex target = *m1;
+      sa.reset(source);
+      sa.reset(target);
       
-      forward_body[source] = true;
-      reverse_body[target] = true;
-      forward_fringe[forward_fringe_size] = source;
-      reverse_fringe[reverse_fringe_size] = target;
-      forward_fringe_size += 1;
-      reverse_fringe_size += 1;
-      
-      while (forward_fringe_size && reverse_fringe_size) {
-        // Regardless of the lengths of the fringes, at every step at this loop level, we must explore both at least once.
-        TIndex this_level[MaxNodes];
-        TIndex this_level_size = forward_fringe_size;
-        memcpy(this_level, forward_fringe, forward_fringe_size * sizeof(forward_fringe[0]));
-        forward_fringe_size = 0;
-        
-        for (TIndex iv = 0; iv < this_level_size; ++iv) {
-          TIndex v = this_level[iv];
-          for (auto w = g.nodes[v].succ_cbegin(); w != g.nodes[v].succ_cend(); ++w) {
-            if (!forbidden_nodes[*w]) {
-              if (reverse_body[*w]) goto found_path;
-              else if (!forward_body[*w]) {
-                forward_fringe[forward_fringe_size] = *w;
-                forward_fringe_size++;
-                
-                forward_body[*w] = true;
-              }
-            }
-          }
-        }
-        
-        this_level_size = reverse_fringe_size;
-        memcpy(this_level, reverse_fringe, reverse_fringe_size * sizeof(reverse_fringe[0]));
-        reverse_fringe_size = 0;
-        
-        for (TIndex iv = 0; iv < this_level_size; ++iv) {
-          TIndex v = this_level[iv];
-          for (auto w = g.nodes[v].pred_cbegin(); w != g.nodes[v].pred_cend(); ++w) {
-            if (!forbidden_nodes[*w]) {
-              if (forward_body[*w]) goto found_path;
-              else if (!reverse_body[*w]) {
-                reverse_fringe[reverse_fringe_size] = *w;
-                reverse_fringe_size++;
-                
-                reverse_body[*w] = true;
-              }
-            }
-          }
-        }
-      }
+      reach.release(source);
+      reach.release(target);
+      reach.add_source(source);
+      reach.add_target(target);
+      if (reach.search()) break;
       
       assert(m1 + 1 <= m2);
       assert(f1 <= f2 - 1);
@@ -273,7 +236,6 @@ Gene<TIndex> cross_fast(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
     }
   }
   
-found_path:
   assert(mother.path.cbegin() <= m1);
   assert(m1 <= m2);
   assert(m2 <= mother.path.cend());
@@ -292,31 +254,38 @@ found_path:
   return out;
 }
 
-template<typename TIndex, typename TDegree, size_t MaxDegree>
-Gene<TIndex> cross_faster(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
-                          TIndex site,
-                          const Gene<TIndex>& mother,
-                          const Gene<TIndex>& father) {
-  const auto m2 = std::find(mother.path.cbegin(), mother.path.cend(), site);
-  const auto f1 = std::find(father.path.cbegin(), father.path.cend(), site) + 1;
+// Writes the child into child, reusing its storage; child must not be mother or father.
+// site is at mother_offset in mother and father_offset in father.
+template<typename TGraph, typename TIndex, size_t Capacity>
+void cross_faster(const TGraph& g,
+                  TIndex site,
+                  const Gene<TIndex>& mother,
+                  size_t mother_offset,
+                  const Gene<TIndex>& father,
+                  size_t father_offset,
+                  SearchContext<TIndex, Capacity>& context,
+                  Gene<TIndex>& child) {
+  assert(mother.path[mother_offset] == site && father.path[father_offset] == site);
+  const auto m2 = mother.path.cbegin() + mother_offset;
+  const auto f1 = father.path.cbegin() + father_offset + 1;
   
   auto m1 = m2;
   auto f2 = f1;
-  NodeSet sa = {};
-  sa[site] = true;
+  NodeSetOf<Capacity> sa = {};
+  sa.set(site);
   
   // Lengthen the shorter of m and f until the remainders are equal
   int mother_more_room = (int)(m1 - mother.path.cbegin()) - (int)(father.path.cend() - f2);
   while (mother_more_room < 0) {
     assert(f2 != father.path.cend());
-    sa[*f2] = true;
+    sa.set(*f2);
     f2++;
     mother_more_room++;
   }
   while (mother_more_room > 0) {
     assert(m1 != mother.path.cbegin());
     m1--;
-    sa[*m1] = true;
+    sa.set(*m1);
     mother_more_room--;
   }
   
@@ -326,8 +295,8 @@ Gene<TIndex> cross_faster(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
     auto mn = *(m1 - 1);
     auto fn = *f2;
     if (mn == fn || sa[mn] || sa[fn]) break;
-    sa[mn] = true;
-    sa[fn] = true;
+    sa.set(mn);
+    sa.set(fn);
     m1--;
     f2++;
   }
@@ -335,80 +304,24 @@ Gene<TIndex> cross_faster(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
   // Now m + site + f is as long as possible without intersecting itself.
   // But we may need to shorten it again to be closable.
   
-  // Copy-paste job from has_path
+  // Shorten m and f together until the child closes. Each step frees the old ends, which
+  // lead into the new ones, so the search carries on from where the last one stopped. The new
+  // ends are released first: a side that had finished skipped them while they were forbidden.
   {
-    NodeSet forward_body = {};
-    NodeSet reverse_body = {};
-    TIndex forward_fringe[MaxNodes];
-    TIndex reverse_fringe[MaxNodes];
-    TIndex forward_fringe_size = 0;
-    TIndex reverse_fringe_size = 0;
-    
-    bool must_expand_both = false;
-    
+    IncrementalReach<TGraph, NodeSetOf<Capacity>, Capacity> reach(g, sa, context);
     while (true) {
-      auto source = *(f2 - 1);
-      auto target = *m1;
-      auto& forbidden_nodes = sa;
-      
-      forbidden_nodes[source] = false;
-      forbidden_nodes[target] = false;
-      
-      forward_body[source] = true;
-      reverse_body[target] = true;
-      forward_fringe[forward_fringe_size] = source;
-      reverse_fringe[reverse_fringe_size] = target;
-      forward_fringe_size += 1;
-      reverse_fringe_size += 1;
+      const TIndex source = *(f2 - 1);
+      const TIndex target = *m1;
+      sa.reset(source);
+      sa.reset(target);
+      if (g.has_edge(source, target)) break;
       
-      while (forward_fringe_size && reverse_fringe_size) {
-        TIndex this_level[MaxNodes];
-        
-        if (must_expand_both || forward_fringe_size < reverse_fringe_size) {
-          TIndex this_level_size = forward_fringe_size;
-          memcpy(this_level, forward_fringe, forward_fringe_size * sizeof(forward_fringe[0]));
-          forward_fringe_size = 0;
-          
-          for (TIndex iv = 0; iv < this_level_size; ++iv) {
-            TIndex v = this_level[iv];
-            for (auto w = g.nodes[v].succ_cbegin(); w != g.nodes[v].succ_cend(); ++w) {
-              if (!forbidden_nodes[*w]) {
-                if (reverse_body[*w]) goto found_path;
-                else if (!forward_body[*w]) {
-                  forward_fringe[forward_fringe_size] = *w;
-                  forward_fringe_size++;
-                  
-                  forward_body[*w] = true;
-                }
-              }
-            }
-          }
-        }
-        
-        if (must_expand_both || forward_fringe_size >= reverse_fringe_size) {
-          TIndex this_level_size = reverse_fringe_size;
-          memcpy(this_level, reverse_fringe, reverse_fringe_size * sizeof(reverse_fringe[0]));
-          reverse_fringe_size = 0;
-          
-          for (TIndex iv = 0; iv < this_level_size; ++iv) {
-            TIndex v = this_level[iv];
-            for (auto w = g.nodes[v].pred_cbegin(); w != g.nodes[v].pred_cend(); ++w) {
-              if (!forbidden_nodes[*w]) {
-                if (forward_body[*w]) goto found_path;
-                else if (!reverse_body[*w]) {
-                  reverse_fringe[reverse_fringe_size] = *w;
-                  reverse_fringe_size++;
-                  
-                  reverse_body[*w] = true;
-                }
-              }
-            }
-          }
-        }
-        
-        // Okay, one force-expand pair is enough.
-        must_expand_both = false;
-      }
+      reach.release(source);
+      reach.release(target);
+      reach.add_source(source);
+      reach.add_target(target);
+      // A cut the dominators prove leaves the search where it is, to carry on next time.
+      if (!cut_off(g, source, target, sa, context) && reach.search()) break;
       
       assert(m1 + 1 <= m2);
       assert(f1 <= f2 - 1);
@@ -422,12 +335,9 @@ Gene<TIndex> cross_faster(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
       assert(father.path.cbegin() <= f1);
       assert(f1 <= f2);
       assert(f2 <= father.path.cend());
-      
-      must_expand_both = true;
     }
   }
   
-found_path:
   assert(mother.path.cbegin() <= m1);
   assert(m1 <= m2);
   assert(m2 <= mother.path.cend());
@@ -435,37 +345,77 @@ found_path:
   assert(f1 <= f2);
   assert(f2 <= father.path.cend());
   
-  Gene<TIndex> out;
-  out.path.reserve((m2 - m1) + 1 + (f2 - f1) + 1); // The last +1 is to accomodate future mutations.
-  out.path.insert(out.path.cend(), m1, m2);
-  out.path.push_back(site);
-  out.path.insert(out.path.cend(), f1, f2);
+  child.path.clear();
+  child.path.reserve((m2 - m1) + 1 + (f2 - f1) + 1); // The last +1 is to accomodate future mutations.
+  child.path.insert(child.path.cend(), m1, m2);
+  child.path.push_back(site);
+  child.path.insert(child.path.cend(), f1, f2);
   
-  assert((out.path.size() == 1) || (out.path.front() != out.path.back()));
-  
-  return out;
+  assert((child.path.size() == 1) || (child.path.front() != child.path.back()));
+}
+
+template<typename TGraph, typename TIndex, size_t Capacity>
+Gene<TIndex> cross_faster(const TGraph& g,
+                          TIndex site,
+                          const Gene<TIndex>& mother,
+                          const Gene<TIndex>& father,
+                          SearchContext<TIndex, Capacity>& context) {
+  const size_t mother_offset = std::find(mother.path.cbegin(), mother.path.cend(), site) - mother.path.cbegin();
+  const size_t father_offset = std::find(father.path.cbegin(), father.path.cend(), site) - father.path.cbegin();
+  Gene<TIndex> child;
+  cross_faster(g, site, mother, mother_offset, father, father_offset, context, child);
+  return child;
+}
+
+// The number of input nodes on the cycle, counting each contracted chain at its full length.
+template<typename TGraph, typename TIndex>
+size_t cycle_weight(const TGraph& g, const Gene<TIndex>& gene) {
+  if (g.weights.empty() || gene.path.size() < 2) return gene.path.size();
+  size_t answer = 0;
+  for (auto node: gene.path) {
+    answer += g.weights[node];
+  }
+  return answer;
+}
+
+// Whether the gene is a simple path of g: no repeated nodes, and an edge between each
+// consecutive pair. A closed cycle also has the edge from the back to the front.
+template<typename TGraph, typename TIndex>
+bool is_path(const TGraph& g, const Gene<TIndex>& gene) {
+  std::vector<bool> seen(g.nodes.size(), false);
+  for (size_t i = 0; i < gene.path.size(); ++i) {
+    if (gene.path[i] >= g.nodes.size() || seen[gene.path[i]]) return false;
+    seen[gene.path[i]] = true;
+    if (i > 0 && !g.has_edge(gene.path[i - 1], gene.path[i])) return false;
+  }
+  return true;
+}
+
+template<typename TGraph, typename TIndex>
+bool is_cycle(const TGraph& g, const Gene<TIndex>& gene) {
+  return is_path(g, gene) && (gene.path.size() < 2 || g.has_edge(gene.path.back(), gene.path.front()));
 }
 
 template<typename TIndex>
 void print(const Gene<TIndex>& gene) {
   std::cout << "Gene of length " << gene.path.size() << ": ";
   for (auto node: gene.path) {
-    std::cout << node << ' ';
+    std::cout << (size_t)node << ' ';
   }
   std::cout << std::endl;
 }
 
-template<typename TIndex, typename TDegree, size_t MaxDegree>
-void print(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g, const Gene<TIndex>& gene) {
-  std::cout << "Gene of length " << gene.path.size() << ": ";
+template<typename TGraph, typename TIndex>
+void print(const TGraph& g, const Gene<TIndex>& gene) {
+  std::cout << "Gene of length " << cycle_weight(g, gene) << ": ";
   for (int i = 0; i < gene.path.size(); ++i) {
 //  for (auto node: gene.path) {
     auto node = gene.path[i];
     auto next = gene.path[(i+1) % gene.path.size()];
     //    std::cout << node << " (" << g.names[node] << ") ";
         std::cout << g.names[node] << " ";
-    bool forward = (std::find(g.nodes[node].succ_cbegin(), g.nodes[node].succ_cend(), next) != g.nodes[node].succ_cend());
-    bool reverse = (std::find(g.nodes[node].pred_cbegin(), g.nodes[node].pred_cend(), next) != g.nodes[node].pred_cend());
+    bool forward = g.has_edge(node, next);
+    bool reverse = g.has_edge(next, node);
 //    if (!forward) {
 //      throw 79;
 //    }
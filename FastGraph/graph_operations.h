@@ -9,108 +9,278 @@
 #ifndef graph_operations_h
 #define graph_operations_h
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "BitAdjacency.h"
+#include "CsrGraph.h"
 #include "NodeSet.h"
 #include "Gene.h"
+#include "SearchContext.h"
 
-template<typename TIndex, typename TDegree, size_t MaxDegree>
-bool has_path(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
-              const TIndex source,
-              const TIndex target,
-              const NodeSet& forbidden_nodes) {
-//  std::cout << "has_path: g.nodes.size()=" << g.nodes.size() << "; source=" << source << "; target=" << target << "; forbidden_nodes=";
-//  print(forbidden_nodes);
-//  std::cout << std::endl;
+// TGraph is FastGraph or CsrGraph: anything whose nodes[v] has succ_cbegin/succ_cend and
+// pred_cbegin/pred_cend, and which names its index type as TGraph::index_type.
+
+// Bidirectional search whose question can grow while it runs. Sources and targets can be
+// added, and nodes the caller has cleared from forbidden_nodes released, and the search goes
+// on from the bodies and fringes it already has, since whatever reached a source or target
+// before still does. Once connected() it is finished.
+template<typename TGraph, typename TSet, size_t Capacity>
+class IncrementalReach {
+  typedef typename TGraph::index_type TIndex;
   
-  if (source == target) return true;
+  const TGraph& g;
+  const TSet& forbidden_nodes;
+  SearchContext<TIndex, Capacity>& context;
+  bool found;
+  
+  // One level of the forward side, or of the reverse side when !Forward.
+  template<bool Forward>
+  void expand() {
+    std::vector<TIndex>& fringe = Forward ? context.forward_fringe : context.reverse_fringe;
+    std::vector<TIndex>& this_level = context.this_level;
+    this_level.swap(fringe);
+    fringe.clear();
+    
+    for (const TIndex v: this_level) {
+      const TIndex* first = Forward ? g.nodes[v].succ_cbegin() : g.nodes[v].pred_cbegin();
+      const TIndex* last = Forward ? g.nodes[v].succ_cend() : g.nodes[v].pred_cend();
+      for (auto w = first; w != last; ++w) {
+        if (forbidden_nodes[*w]) continue;
+        if (Forward ? context.in_reverse_body(*w) : context.in_forward_body(*w)) {
+          found = true;
+          return;
+        }
+        if (Forward ? !context.in_forward_body(*w) : !context.in_reverse_body(*w)) {
+          fringe.push_back(*w);
+          if (Forward) context.add_to_forward_body(*w);
+          else context.add_to_reverse_body(*w);
+        }
+      }
+    }
+  }
   
-  NodeSet forward_body = {};
-  NodeSet reverse_body = {};
-  forward_body[source] = true;
-  reverse_body[target] = true;
+public:
+  IncrementalReach(const TGraph& g, const TSet& forbidden_nodes, SearchContext<TIndex, Capacity>& context)
+  : g(g), forbidden_nodes(forbidden_nodes), context(context), found(false) {
+    context.begin_search();
+  }
   
-  TIndex forward_fringe[MaxNodes] = {};
-  TIndex reverse_fringe[MaxNodes] = {};
-  TIndex forward_fringe_size = 1;
-  TIndex reverse_fringe_size = 1;
-  forward_fringe[0] = source;
-  reverse_fringe[0] = target;
+  bool connected() const { return found; }
+  // v is known to lead to a target, or to be reached from a source.
+  bool reaches_target(TIndex v) const { return context.in_reverse_body(v); }
+  bool reached_from_source(TIndex v) const { return context.in_forward_body(v); }
   
-  while (forward_fringe_size && reverse_fringe_size) {
-    if (forward_fringe_size < reverse_fringe_size) {
-      TIndex this_level[MaxNodes] = {};
-      TIndex this_level_size = forward_fringe_size;
-      memcpy(this_level, forward_fringe, forward_fringe_size * sizeof(forward_fringe[0]));
-      forward_fringe_size = 0;
-      
-      for (TIndex iv = 0; iv < this_level_size; ++iv) {
-        TIndex v = this_level[iv];
-//        std::cout << "Expanding " << v << " forward" << std::endl;
-        for (auto w = g.nodes[v].succ_cbegin(); w != g.nodes[v].succ_cend(); ++w) {
-          if (forbidden_nodes[*w]) {
-//            std::cout << "  " << *w << " is forbidden" << std::endl;
-          } else {
-            if (reverse_body[*w]) {
-//              std::cout << "  Found connection! reverse_body[" << *w << "]" << std::endl;
-              return true;
-            }
-            else if (!forward_body[*w]) {
-//              std::cout << "  Pushing " << *w << " forward" << std::endl;
-              forward_fringe[forward_fringe_size] = *w;
-              forward_fringe_size++;
-              
-              forward_body[*w] = true;
-            }
-          }
-        }
+  void add_source(TIndex v) {
+    if (context.in_reverse_body(v)) {
+      found = true;
+    } else if (!context.in_forward_body(v)) {
+      context.add_to_forward_body(v);
+      context.forward_fringe.push_back(v);
+    }
+  }
+  
+  void add_target(TIndex v) {
+    if (context.in_forward_body(v)) {
+      found = true;
+    } else if (!context.in_reverse_body(v)) {
+      context.add_to_reverse_body(v);
+      context.reverse_fringe.push_back(v);
+    }
+  }
+  
+  // v has just been cleared from forbidden_nodes; it joins whichever bodies it now touches.
+  void release(TIndex v) {
+    for (auto u = g.nodes[v].pred_cbegin(); u != g.nodes[v].pred_cend(); ++u) {
+      if (context.in_forward_body(*u)) {
+        add_source(v);
+        break;
       }
-    } else {
-      TIndex this_level[MaxNodes] = {};
-      TIndex this_level_size = reverse_fringe_size;
-      memcpy(this_level, reverse_fringe, reverse_fringe_size * sizeof(reverse_fringe[0]));
-      reverse_fringe_size = 0;
-      
-      for (TIndex iv = 0; iv < this_level_size; ++iv) {
-        TIndex v = this_level[iv];
-//        std::cout << "Expanding " << v << " backward" << std::endl;
-        for (auto w = g.nodes[v].pred_cbegin(); w != g.nodes[v].pred_cend(); ++w) {
-          if (forbidden_nodes[*w]) {
-//            std::cout << "  " << *w << " is forbidden" << std::endl;
-          } else {
-            if (forward_body[*w]) {
-//              std::cout << "  Found connection! forward_body[" << *w << "]" << std::endl;
-              return true;
-            }
-            else if (!reverse_body[*w]) {
-//              std::cout << "  Pushing " << *w << " backward" << std::endl;
-              reverse_fringe[reverse_fringe_size] = *w;
-              reverse_fringe_size++;
-              
-              reverse_body[*w] = true;
-            }
-          }
-        }
+    }
+    for (auto w = g.nodes[v].succ_cbegin(); w != g.nodes[v].succ_cend(); ++w) {
+      if (context.in_reverse_body(*w)) {
+        add_target(v);
+        break;
       }
     }
   }
   
-  return false;
+  // Expands the smaller fringe until the sides meet or one side has nothing left, which
+  // settles the question as it stands. Returns connected().
+  bool search() {
+    while (!found && !context.forward_fringe.empty() && !context.reverse_fringe.empty()) {
+      if (context.forward_fringe.size() < context.reverse_fringe.size()) expand<true>();
+      else expand<false>();
+    }
+    return found;
+  }
+  
+  // One more level of one side alone; false once that side has nothing left.
+  bool expand_sources() {
+    if (found || context.forward_fringe.empty()) return false;
+    expand<true>();
+    return true;
+  }
+  
+  bool expand_targets() {
+    if (found || context.reverse_fringe.empty()) return false;
+    expand<false>();
+    return true;
+  }
+};
+
+template<typename TGraph, typename TSet, size_t Capacity>
+bool has_path(const TGraph& g,
+              const typename TGraph::index_type source,
+              const typename TGraph::index_type target,
+              const TSet& forbidden_nodes,
+              SearchContext<typename TGraph::index_type, Capacity>& context) {
+  if (source == target) return true;
+  IncrementalReach<TGraph, TSet, Capacity> reach(g, forbidden_nodes, context);
+  reach.add_source(source);
+  reach.add_target(target);
+  return reach.search();
 }
 
+template<typename TGraph, typename TSet>
+bool has_path(const TGraph& g,
+              const typename TGraph::index_type source,
+              const typename TGraph::index_type target,
+              const TSet& forbidden_nodes) {
+  SearchContext<typename TGraph::index_type> context(g.nodes.size());
+  return has_path(g, source, target, forbidden_nodes, context);
+}
 
-template<typename TIndex, typename TDegree, size_t MaxDegree>
-bool has_path(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
-              std::vector<TIndex> base_path) {
-  NodeSet forbidden = {};
+// True if g's dominator table shows that forbidden_nodes cut every path from source to
+// target, so a search would fail. False if it cannot tell, or g has no table.
+template<typename TGraph, typename TSet, size_t Capacity>
+bool cut_off(const TGraph& g,
+             const typename TGraph::index_type source,
+             const typename TGraph::index_type target,
+             const TSet& forbidden_nodes,
+             SearchContext<typename TGraph::index_type, Capacity>& context) {
+  if (!g.has_dominators()) return false;
+  context.dominator_checks += 1;
+  if (!g.dominators.blocks(source, target, forbidden_nodes)) return false;
+  context.dominator_rejections += 1;
+  return true;
+}
+
+// The first of candidates, in list order, that connects to root without passing through
+// forbidden_nodes; candidates.size() if none does. Backward asks whether the candidate leads
+// to root, forward whether root leads to it. Candidates the dominator table rules out are
+// passed over. The first one left usually connects, so it gets a bidirectional search of its
+// own; if that fails, root's side of the same search carries on alone and settles the rest,
+// so a failing operator costs at most one search whatever the degree.
+template<bool Backward, typename TGraph, typename TSet, size_t Capacity>
+size_t first_connected(const TGraph& g,
+                       const typename TGraph::index_type root,
+                       const std::vector<typename TGraph::index_type>& candidates,
+                       const TSet& forbidden_nodes,
+                       SearchContext<typename TGraph::index_type, Capacity>& context) {
+  if (candidates.empty()) return 0;
+  if (Backward ? g.has_edge(candidates[0], root) : g.has_edge(root, candidates[0])) return 0;
+  
+  size_t first = 0;
+  while (first < candidates.size() &&
+         (Backward ? cut_off(g, candidates[first], root, forbidden_nodes, context)
+                   : cut_off(g, root, candidates[first], forbidden_nodes, context))) {
+    ++first;
+  }
+  if (first == candidates.size()) return first;
+  
+  IncrementalReach<TGraph, TSet, Capacity> reach(g, forbidden_nodes, context);
+  if (Backward) {
+    reach.add_source(candidates[first]);
+    reach.add_target(root);
+  } else {
+    reach.add_source(root);
+    reach.add_target(candidates[first]);
+  }
+  if (reach.search()) return first;
+  
+  // One side ran dry without meeting the other. If it was root's, that side is complete; if
+  // it was the candidate's, root's side can carry on alone and never meet it. Either way,
+  // every later candidate that root's side takes in connects.
+  size_t best = candidates.size();
+  do {
+    for (size_t k = first + 1; k < best; ++k) {
+      if (Backward ? reach.reaches_target(candidates[k]) : reach.reached_from_source(candidates[k])) {
+        best = k;
+        break;
+      }
+    }
+  } while (best > first + 1 && (Backward ? reach.expand_targets() : reach.expand_sources()));
+  return best;
+}
+
+// Same bidirectional search, but each fringe is a bitset and a level is expanded
+// by OR-ing whole adjacency rows, then masking out forbidden and visited nodes.
+template<size_t Capacity>
+bool has_path(const BitAdjacency<Capacity>& adjacency,
+              const size_t source,
+              const size_t target,
+              const BitNodeSet<Capacity>& forbidden_nodes) {
+  typedef BitNodeSet<Capacity> TSet;
+  if (source == target) return true;
+  
+  TSet forward_body = {};
+  TSet reverse_body = {};
+  TSet forward_fringe = {};
+  TSet reverse_fringe = {};
+  TSet next_level;
+  forward_body.set(source);
+  reverse_body.set(target);
+  forward_fringe.set(source);
+  reverse_fringe.set(target);
+  size_t forward_fringe_size = 1;
+  size_t reverse_fringe_size = 1;
+  
+  while (forward_fringe_size && reverse_fringe_size) {
+    const bool forward = forward_fringe_size < reverse_fringe_size;
+    const std::vector<TSet>& rows = forward ? adjacency.succ : adjacency.pred;
+    TSet& fringe = forward ? forward_fringe : reverse_fringe;
+    TSet& body = forward ? forward_body : reverse_body;
+    const TSet& other_body = forward ? reverse_body : forward_body;
+    
+    next_level.clear();
+    fringe.for_each([&](size_t v) { next_level.unite(rows[v]); });
+    next_level.subtract(forbidden_nodes);
+    if (next_level.intersects(other_body)) return true;
+    next_level.subtract(body);
+    body.unite(next_level);
+    fringe = next_level;
+    
+    if (forward) forward_fringe_size = fringe.count();
+    else reverse_fringe_size = fringe.count();
+  }
+  
+  return false;
+}
+
+template<typename TGraph, size_t Capacity>
+bool has_path(const TGraph& g,
+              const std::vector<typename TGraph::index_type>& base_path,
+              SearchContext<typename TGraph::index_type, Capacity>& context) {
+  NodeSetOf<Capacity> forbidden = {};
   if (base_path.size() > 2) {
     flatten(forbidden, base_path.cbegin() + 1, base_path.cend() - 1);
   }
-  return has_path(g, base_path.back(), base_path.front(), forbidden);
+  return has_path(g, base_path.back(), base_path.front(), forbidden, context);
 }
 
-template<typename TIndex, typename TDegree, size_t MaxDegree>
-bool has_path(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
-              const TIndex source,
-              const TIndex target) {
+template<typename TGraph>
+bool has_path(const TGraph& g,
+              const std::vector<typename TGraph::index_type>& base_path) {
+  SearchContext<typename TGraph::index_type> context(g.nodes.size());
+  return has_path(g, base_path, context);
+}
+
+template<typename TGraph>
+bool has_path(const TGraph& g,
+              const typename TGraph::index_type source,
+              const typename TGraph::index_type target) {
   return has_path(g, source, target, NodeSet{});
 }
 
@@ -120,26 +290,424 @@ void remove_node(FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
 //  std::cout << "Removing unreachable node: " << target << " (" << g.names[target] << ")" << std::endl;
   g.nodes.erase(g.nodes.begin() + target);
   g.names.erase(g.names.begin() + target);
+  g.original_ids.erase(g.original_ids.begin() + target);
+  if (!g.weights.empty()) g.weights.erase(g.weights.begin() + target);
   for (auto& node: g.nodes) {
     node.remove_all_connections(target);
   }
+  g.edge_matrix = EdgeMatrix();
+  g.dominators = DominatorTable();
 }
 
+// Component id of every node, plus the size of each component.
+// Ids come out of Tarjan's algorithm in reverse topological order of the condensation.
+struct Components {
+  std::vector<uint32_t> membership;
+  std::vector<uint32_t> sizes;
+};
+
+// Tarjan's algorithm with an explicit stack, so deep graphs cannot overflow the call stack. O(V+E).
+template<typename TGraph>
+Components strongly_connected_components(const TGraph& g) {
+  typedef typename TGraph::index_type TIndex;
+  constexpr uint32_t unvisited = UINT32_MAX;
+  const uint32_t n = (uint32_t)g.nodes.size();
+  
+  Components answer;
+  answer.membership.assign(n, unvisited);
+  std::vector<uint32_t> index(n, unvisited);
+  std::vector<uint32_t> lowlink(n, 0);
+  std::vector<uint32_t> component_stack;
+  std::vector<std::pair<uint32_t, const TIndex*>> call_stack;
+  uint32_t next_index = 0;
+  
+  for (uint32_t root = 0; root < n; ++root) {
+    if (index[root] != unvisited) continue;
+    
+    index[root] = lowlink[root] = next_index++;
+    component_stack.push_back(root);
+    call_stack.emplace_back(root, g.nodes[root].succ_cbegin());
+    
+    while (!call_stack.empty()) {
+      const uint32_t v = call_stack.back().first;
+      const TIndex*& next_successor = call_stack.back().second;
+      
+      if (next_successor != g.nodes[v].succ_cend()) {
+        const uint32_t w = *next_successor++;
+        if (index[w] == unvisited) {
+          index[w] = lowlink[w] = next_index++;
+          component_stack.push_back(w);
+          call_stack.emplace_back(w, g.nodes[w].succ_cbegin());
+        } else if (answer.membership[w] == unvisited) {
+          // w is still on the component stack
+          lowlink[v] = std::min(lowlink[v], index[w]);
+        }
+        continue;
+      }
+      
+      call_stack.pop_back();
+      if (!call_stack.empty()) {
+        const uint32_t parent = call_stack.back().first;
+        lowlink[parent] = std::min(lowlink[parent], lowlink[v]);
+      }
+      if (lowlink[v] == index[v]) {
+        const uint32_t component = (uint32_t)answer.sizes.size();
+        answer.sizes.push_back(0);
+        uint32_t w;
+        do {
+          w = component_stack.back();
+          component_stack.pop_back();
+          answer.membership[w] = component;
+          answer.sizes[component] += 1;
+        } while (w != v);
+      }
+    }
+  }
+  
+  return answer;
+}
+
+// Drops every node without keep[i] in one pass, preserving the order of the survivors
+// and of each survivor's neighbor lists. Names, original_ids and weights move with their nodes.
+// Returns the old -> new index map, with UINT32_MAX for dropped nodes.
 template<typename TIndex, typename TDegree, size_t MaxDegree>
-void restrict_to_scc(FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
-                     const TIndex source) {
-  bool found_outlier = true;
-  while (found_outlier) {
-    found_outlier = false;
-    for (TIndex i = 0; i < g.nodes.size(); ++i) {
-      if (!has_path(g, source, i) || !has_path(g, i, source)) {
-        remove_node(g, i);
-        --i;
-        found_outlier = true;
-        break;
+std::vector<uint32_t> compact(FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
+                              const std::vector<bool>& keep) {
+  std::vector<uint32_t> remap(g.nodes.size(), UINT32_MAX);
+  uint32_t kept = 0;
+  for (size_t i = 0; i < g.nodes.size(); ++i) {
+    if (keep[i]) remap[i] = kept++;
+  }
+  
+  FastGraph<Node<TIndex, TDegree, MaxDegree>> answer;
+  answer.nodes.resize(kept);
+  answer.names.reserve(kept);
+  answer.original_ids.reserve(kept);
+  for (size_t i = 0; i < g.nodes.size(); ++i) {
+    if (!keep[i]) continue;
+    auto& node = answer.nodes[remap[i]];
+    for (auto w = g.nodes[i].succ_cbegin(); w != g.nodes[i].succ_cend(); ++w) {
+      if (keep[*w]) node.succ_push(remap[*w]);
+    }
+    for (auto w = g.nodes[i].pred_cbegin(); w != g.nodes[i].pred_cend(); ++w) {
+      if (keep[*w]) node.pred_push(remap[*w]);
+    }
+    answer.names.push_back(g.names[i]);
+    answer.original_ids.push_back(g.original_ids[i]);
+    if (!g.weights.empty()) answer.weights.push_back(g.weights[i]);
+  }
+  
+  // answer has no edge matrix or dominator table, so g's, which no longer match the
+  // numbering, go too.
+  g = std::move(answer);
+  return remap;
+}
+
+// Keeps only the strongly connected component containing source.
+template<typename TGraph>
+std::vector<uint32_t> restrict_to_scc(TGraph& g,
+                                      const typename TGraph::index_type source) {
+  Components components = strongly_connected_components(g);
+  std::vector<bool> keep(g.nodes.size());
+  for (size_t i = 0; i < g.nodes.size(); ++i) {
+    keep[i] = (components.membership[i] == components.membership[source]);
+  }
+  return compact(g, keep);
+}
+
+// Each component with at least min_size nodes as a graph of its own, largest first.
+// Node order, neighbor order, names, original_ids and weights are preserved within each part.
+template<typename TIndex, typename TDegree, size_t MaxDegree>
+std::vector<FastGraph<Node<TIndex, TDegree, MaxDegree>>> extract_components(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
+                                                                            const Components& components,
+                                                                            size_t min_size) {
+  std::vector<FastGraph<Node<TIndex, TDegree, MaxDegree>>> parts(components.sizes.size());
+  std::vector<uint32_t> local(g.nodes.size());
+  for (size_t i = 0; i < g.nodes.size(); ++i) {
+    auto& part = parts[components.membership[i]];
+    local[i] = (uint32_t)part.nodes.size();
+    part.nodes.emplace_back();
+    part.names.push_back(g.names[i]);
+    part.original_ids.push_back(g.original_ids[i]);
+    if (!g.weights.empty()) part.weights.push_back(g.weights[i]);
+  }
+  // All successors before any predecessors, so succ_push never shifts anything.
+  for (size_t i = 0; i < g.nodes.size(); ++i) {
+    const uint32_t c = components.membership[i];
+    for (auto w = g.nodes[i].succ_cbegin(); w != g.nodes[i].succ_cend(); ++w) {
+      if (components.membership[*w] == c) parts[c].nodes[local[i]].succ_push(local[*w]);
+    }
+  }
+  for (size_t i = 0; i < g.nodes.size(); ++i) {
+    const uint32_t c = components.membership[i];
+    for (auto w = g.nodes[i].pred_cbegin(); w != g.nodes[i].pred_cend(); ++w) {
+      if (components.membership[*w] == c) parts[c].nodes[local[i]].pred_push(local[*w]);
+    }
+  }
+  
+  parts.erase(std::remove_if(parts.begin(), parts.end(), [&](const FastGraph<Node<TIndex, TDegree, MaxDegree>>& part) {
+    return part.nodes.size() < min_size;
+  }), parts.end());
+  std::stable_sort(parts.begin(), parts.end(), [](const FastGraph<Node<TIndex, TDegree, MaxDegree>>& a,
+                                                  const FastGraph<Node<TIndex, TDegree, MaxDegree>>& b) {
+    return a.nodes.size() > b.nodes.size();
+  });
+  return parts;
+}
+
+// Every strongly connected component that can hold a cycle, largest first.
+template<typename TIndex, typename TDegree, size_t MaxDegree>
+std::vector<FastGraph<Node<TIndex, TDegree, MaxDegree>>> split_into_sccs(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g) {
+  return extract_components(g, strongly_connected_components(g), 2);
+}
+
+// The subgraph induced by vertices, which must be in ascending order.
+template<typename TIndex, typename TDegree, size_t MaxDegree>
+FastGraph<Node<TIndex, TDegree, MaxDegree>> induced_subgraph(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
+                                                             const std::vector<uint32_t>& vertices,
+                                                             std::vector<uint32_t>& scratch_local) {
+  // scratch_local must be g.nodes.size() entries of UINT32_MAX; it is restored before returning.
+  FastGraph<Node<TIndex, TDegree, MaxDegree>> answer;
+  answer.nodes.resize(vertices.size());
+  for (uint32_t i = 0; i < vertices.size(); ++i) {
+    scratch_local[vertices[i]] = i;
+    answer.names.push_back(g.names[vertices[i]]);
+    answer.original_ids.push_back(g.original_ids[vertices[i]]);
+    if (!g.weights.empty()) answer.weights.push_back(g.weights[vertices[i]]);
+  }
+  for (uint32_t i = 0; i < vertices.size(); ++i) {
+    const auto& node = g.nodes[vertices[i]];
+    for (auto w = node.succ_cbegin(); w != node.succ_cend(); ++w) {
+      if (scratch_local[*w] != UINT32_MAX) answer.nodes[i].succ_push(scratch_local[*w]);
+    }
+  }
+  for (uint32_t i = 0; i < vertices.size(); ++i) {
+    const auto& node = g.nodes[vertices[i]];
+    for (auto w = node.pred_cbegin(); w != node.pred_cend(); ++w) {
+      if (scratch_local[*w] != UINT32_MAX) answer.nodes[i].pred_push(scratch_local[*w]);
+    }
+  }
+  for (const uint32_t v: vertices) {
+    scratch_local[v] = UINT32_MAX;
+  }
+  return answer;
+}
+
+// Neighbors of every node in the underlying undirected graph, in ascending order,
+// without self-loops or parallel edges.
+template<typename TGraph>
+std::vector<std::vector<uint32_t>> undirected_neighbors(const TGraph& g) {
+  const uint32_t n = (uint32_t)g.nodes.size();
+  std::vector<std::vector<uint32_t>> neighbors(n);
+  for (uint32_t v = 0; v < n; ++v) {
+    neighbors[v].insert(neighbors[v].end(), g.nodes[v].succ_cbegin(), g.nodes[v].succ_cend());
+    neighbors[v].insert(neighbors[v].end(), g.nodes[v].pred_cbegin(), g.nodes[v].pred_cend());
+    std::sort(neighbors[v].begin(), neighbors[v].end());
+    neighbors[v].erase(std::unique(neighbors[v].begin(), neighbors[v].end()), neighbors[v].end());
+    neighbors[v].erase(std::remove(neighbors[v].begin(), neighbors[v].end(), v), neighbors[v].end());
+  }
+  return neighbors;
+}
+
+// Vertex sets of the biconnected components (blocks) of the underlying undirected graph,
+// each in ascending order. Hopcroft-Tarjan with explicit stacks. O(V+E).
+// Two blocks share at most one (cut) vertex, so every edge lies in exactly one block's
+// induced subgraph, and so does every simple cycle.
+template<typename TGraph>
+std::vector<std::vector<uint32_t>> biconnected_blocks(const TGraph& g) {
+  constexpr uint32_t unvisited = UINT32_MAX;
+  const uint32_t n = (uint32_t)g.nodes.size();
+  
+  const std::vector<std::vector<uint32_t>> neighbors = undirected_neighbors(g);
+  
+  std::vector<std::vector<uint32_t>> blocks;
+  std::vector<uint32_t> discovered(n, unvisited);
+  std::vector<uint32_t> low(n, 0);
+  std::vector<uint32_t> vertex_stack;
+  struct Frame { uint32_t v; uint32_t parent; uint32_t next_neighbor; };
+  std::vector<Frame> call_stack;
+  uint32_t time = 0;
+  
+  for (uint32_t root = 0; root < n; ++root) {
+    if (discovered[root] != unvisited) continue;
+    
+    discovered[root] = low[root] = time++;
+    vertex_stack.push_back(root);
+    call_stack.push_back(Frame{root, unvisited, 0});
+    
+    while (!call_stack.empty()) {
+      Frame& frame = call_stack.back();
+      const uint32_t v = frame.v;
+      
+      if (frame.next_neighbor < neighbors[v].size()) {
+        const uint32_t w = neighbors[v][frame.next_neighbor++];
+        if (discovered[w] == unvisited) {
+          discovered[w] = low[w] = time++;
+          vertex_stack.push_back(w);
+          call_stack.push_back(Frame{w, v, 0});
+        } else if (w != frame.parent) {
+          low[v] = std::min(low[v], discovered[w]);
+        }
+        continue;
+      }
+      
+      call_stack.pop_back();
+      if (call_stack.empty()) {
+        // Only the root is left on the vertex stack; its blocks were emitted by its children.
+        vertex_stack.pop_back();
+        continue;
+      }
+      
+      const uint32_t u = call_stack.back().v;
+      low[u] = std::min(low[u], low[v]);
+      if (low[v] >= discovered[u]) {
+        // u separates the subtree under v: everything above v on the stack, plus u, is a block.
+        blocks.emplace_back();
+        uint32_t w;
+        do {
+          w = vertex_stack.back();
+          vertex_stack.pop_back();
+          blocks.back().push_back(w);
+        } while (w != v);
+        blocks.back().push_back(u);
+        std::sort(blocks.back().begin(), blocks.back().end());
+      }
+    }
+  }
+  
+  return blocks;
+}
+
+// Every strongly connected piece of every block that can hold a cycle, largest first.
+// Cut vertices appear in each block they join; names and original_ids identify them.
+template<typename TIndex, typename TDegree, size_t MaxDegree>
+std::vector<FastGraph<Node<TIndex, TDegree, MaxDegree>>> split_into_blocks(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g) {
+  std::vector<FastGraph<Node<TIndex, TDegree, MaxDegree>>> parts;
+  std::vector<uint32_t> scratch_local(g.nodes.size(), UINT32_MAX);
+  for (const auto& block: biconnected_blocks(g)) {
+    if (block.size() < 2) continue;
+    for (auto& part: split_into_sccs(induced_subgraph(g, block, scratch_local))) {
+      parts.push_back(std::move(part));
+    }
+  }
+  std::stable_sort(parts.begin(), parts.end(), [](const FastGraph<Node<TIndex, TDegree, MaxDegree>>& a,
+                                                  const FastGraph<Node<TIndex, TDegree, MaxDegree>>& b) {
+    return a.nodes.size() > b.nodes.size();
+  });
+  return parts;
+}
+
+// Node orders for relabel: order[i] is the node that becomes node i.
+
+// Breadth-first over the undirected graph from each unvisited node in turn. With by_degree,
+// roots are the lowest-degree unvisited nodes and neighbors are queued lowest degree first,
+// which is Cuthill-McKee.
+template<typename TGraph>
+std::vector<uint32_t> breadth_first_order(const TGraph& g, bool by_degree) {
+  const uint32_t n = (uint32_t)g.nodes.size();
+  std::vector<std::vector<uint32_t>> neighbors = undirected_neighbors(g);
+  std::vector<uint32_t> roots(n);
+  for (uint32_t v = 0; v < n; ++v) roots[v] = v;
+  if (by_degree) {
+    auto fewer_neighbors = [&](uint32_t a, uint32_t b) { return neighbors[a].size() < neighbors[b].size(); };
+    std::stable_sort(roots.begin(), roots.end(), fewer_neighbors);
+    for (auto& list: neighbors) {
+      std::stable_sort(list.begin(), list.end(), fewer_neighbors);
+    }
+  }
+  
+  std::vector<uint32_t> order;
+  order.reserve(n);
+  std::vector<bool> queued(n, false);
+  for (const uint32_t root: roots) {
+    if (queued[root]) continue;
+    queued[root] = true;
+    order.push_back(root);
+    // order doubles as the queue: everything from head on is still to be expanded.
+    for (size_t head = order.size() - 1; head < order.size(); ++head) {
+      for (const uint32_t w: neighbors[order[head]]) {
+        if (!queued[w]) {
+          queued[w] = true;
+          order.push_back(w);
+        }
       }
     }
   }
+  return order;
+}
+
+// Reverse Cuthill-McKee keeps the two ends of every edge close in the numbering,
+// so one BFS level touches few cache lines of g.nodes and of the node sets.
+template<typename TGraph>
+std::vector<uint32_t> rcm_order(const TGraph& g) {
+  std::vector<uint32_t> order = breadth_first_order(g, true);
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
+// Busiest nodes first: every search passes through them, so they share cache lines.
+template<typename TGraph>
+std::vector<uint32_t> degree_order(const TGraph& g) {
+  std::vector<uint32_t> order(g.nodes.size());
+  for (uint32_t v = 0; v < order.size(); ++v) order[v] = v;
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    return g.nodes[a].get_out_degree() + g.nodes[a].get_in_degree() > g.nodes[b].get_out_degree() + g.nodes[b].get_in_degree();
+  });
+  return order;
+}
+
+template<typename TGraph>
+std::vector<uint32_t> node_order(const TGraph& g, NodeOrder kind) {
+  switch (kind) {
+    case NodeOrder::bfs: return breadth_first_order(g, false);
+    case NodeOrder::rcm: return rcm_order(g);
+    case NodeOrder::degree: return degree_order(g);
+    default: break;
+  }
+  std::vector<uint32_t> order(g.nodes.size());
+  for (uint32_t v = 0; v < order.size(); ++v) order[v] = v;
+  return order;
+}
+
+// Renumbers g so that node i is the old node order[i]. Names, original_ids and weights move
+// with their nodes, so printed cycles are unchanged, and every neighbor list keeps its order.
+// Returns the old-to-new map, like compact.
+template<typename TIndex, typename TDegree, size_t MaxDegree>
+std::vector<uint32_t> relabel(FastGraph<Node<TIndex, TDegree, MaxDegree>>& g,
+                              const std::vector<uint32_t>& order) {
+  std::vector<uint32_t> remap(g.nodes.size());
+  for (uint32_t i = 0; i < order.size(); ++i) remap[order[i]] = i;
+  
+  FastGraph<Node<TIndex, TDegree, MaxDegree>> answer;
+  answer.nodes.resize(order.size());
+  for (uint32_t i = 0; i < order.size(); ++i) {
+    const auto& node = g.nodes[order[i]];
+    for (auto w = node.succ_cbegin(); w != node.succ_cend(); ++w) {
+      answer.nodes[i].succ_push(remap[*w]);
+    }
+    for (auto w = node.pred_cbegin(); w != node.pred_cend(); ++w) {
+      answer.nodes[i].pred_push(remap[*w]);
+    }
+    answer.names.push_back(g.names[order[i]]);
+    answer.original_ids.push_back(g.original_ids[order[i]]);
+    if (!g.weights.empty()) answer.weights.push_back(g.weights[order[i]]);
+  }
+  
+  // answer has no edge matrix or dominator table, so g's, which no longer match the
+  // numbering, go too.
+  g = std::move(answer);
+  return remap;
+}
+
+// The same cycle in a graph renumbered by relabel, given the map relabel returned.
+template<typename TIndex>
+Gene<TIndex> relabel(const Gene<TIndex>& gene, const std::vector<uint32_t>& remap) {
+  Gene<TIndex> answer;
+  answer.path.reserve(gene.path.size());
+  for (const TIndex v: gene.path) {
+    answer.path.push_back(remap[v]);
+  }
+  return answer;
 }
 
 #endif /* graph_operations_h */
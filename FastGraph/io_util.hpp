@@ -9,83 +9,254 @@
 #ifndef io_util_hpp
 #define io_util_hpp
 
-#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "CsrGraph.h"
 #include "FastGraph.h"
 #include "io_util.hpp"
-#include "string_util.h"
 
-std::unordered_map<std::string, std::string> load_csv() {
-  std::unordered_map<std::string, std::string> map;
-  
-  std::ifstream infile;
-  infile.open("names.csv");
-  
-  std::string line;
-  while (std::getline(infile, line))
-  {
-    auto pos = line.find_first_of(',');
-    std::string key(line.cbegin(), line.cbegin() + pos);
-    std::string value(line.cbegin() + pos + 1, line.cend() - 1);
-    map[key] = value;
-    
-//    std::cout << key << " will be renamed as " << value << std::endl;
+// A read-only view of a whole file. The pages are mapped, never copied.
+class MappedFile {
+  const char* data_;
+  size_t size_;
+
+public:
+  explicit MappedFile(const char* path): data_(nullptr), size_(0) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+      std::cout << "Could not open " << path << std::endl;
+      return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+      void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped != MAP_FAILED) {
+        data_ = static_cast<const char*>(mapped);
+        size_ = info.st_size;
+        madvise(mapped, size_, MADV_SEQUENTIAL);
+      }
+    }
+    close(fd);
   }
-  
+  ~MappedFile() {
+    if (data_) munmap(const_cast<char*>(data_), size_);
+  }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* begin() const { return data_; }
+  const char* end() const { return data_ + size_; }
+  size_t size() const { return size_; }
+};
+
+// A string_view-style slice into a MappedFile.
+struct Slice {
+  const char* first;
+  const char* last;
+
+  size_t size() const { return last - first; }
+  std::string str() const { return std::string(first, last); }
+
+  Slice trimmed() const {
+    const char* b = first;
+    const char* e = last;
+    while (b < e && isspace((unsigned char)*b)) ++b;
+    while (e > b && isspace((unsigned char)*(e - 1))) --e;
+    return Slice{b, e};
+  }
+
+  // Same result as atoi on the slice's characters.
+  int to_int() const {
+    const char* p = first;
+    while (p < last && isspace((unsigned char)*p)) ++p;
+    bool negative = (p < last && *p == '-');
+    if (p < last && (*p == '-' || *p == '+')) ++p;
+    int answer = 0;
+    for (; p < last && '0' <= *p && *p <= '9'; ++p) {
+      answer = answer * 10 + (*p - '0');
+    }
+    return negative ? -answer : answer;
+  }
+
+  bool operator==(const Slice& other) const {
+    return size() == other.size() && memcmp(first, other.first, size()) == 0;
+  }
+};
+
+struct SliceHash {
+  size_t operator()(const Slice& s) const {
+    // FNV-1a
+    uint64_t h = 14695981039346656037ull;
+    for (const char* p = s.first; p != s.last; ++p) {
+      h = (h ^ (unsigned char)*p) * 1099511628211ull;
+    }
+    return h;
+  }
+};
+
+typedef std::unordered_map<Slice, Slice, SliceHash> NameMap;
+
+// Calls f(line) for each line in [begin, end), without the trailing newline.
+template<typename F>
+void for_each_line(const char* begin, const char* end, F f) {
+  while (begin < end) {
+    const char* newline = static_cast<const char*>(memchr(begin, '\n', end - begin));
+    const char* line_end = newline ? newline : end;
+    f(Slice{begin, line_end});
+    begin = line_end + 1;
+  }
+}
+
+// Maps each raw Massey team name to its display name. Both slices point into names_file.
+NameMap load_csv(const MappedFile& names_file) {
+  NameMap map;
+
+  for_each_line(names_file.begin(), names_file.end(), [&](Slice line) {
+    const char* pos = static_cast<const char*>(memchr(line.first, ',', line.size()));
+    if (!pos || line.last == pos + 1) return;
+    Slice key{line.first, pos};
+    Slice value{pos + 1, line.last - 1};
+    map[key] = value;
+
+//    std::cout << key.str() << " will be renamed as " << value.str() << std::endl;
+  });
+
   return map;
 }
 
+// Edges parsed from one chunk of edges.txt, with chunk-local node ids in first-appearance order.
+struct MasseyChunk {
+  std::vector<Slice> names;
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+};
+
+void parse_massey_chunk(const char* begin, const char* end, const NameMap& name_map, MasseyChunk& chunk) {
+  std::unordered_map<Slice, uint32_t, SliceHash> local_index;
+  const Slice unknown{begin, begin};
+
+  auto intern = [&](Slice raw_name) {
+    auto renamed = name_map.find(raw_name.trimmed());
+    const Slice& name = (renamed != name_map.end()) ? renamed->second : unknown;
+    auto inserted = local_index.emplace(name, (uint32_t)chunk.names.size());
+    if (inserted.second) {
+      chunk.names.push_back(name);
+    }
+    return inserted.first->second;
+  };
+
+  for_each_line(begin, end, [&](Slice line) {
+    // Fixed-width columns: name 12-37, score 37-39, name 41-66, score 66-68.
+    if (line.size() < 68) return;
+    uint32_t node_index_a = intern(Slice{line.first + 12, line.first + 37});
+    uint32_t node_index_b = intern(Slice{line.first + 41, line.first + 66});
+    int nscore_a = Slice{line.first + 37, line.first + 39}.to_int();
+    int nscore_b = Slice{line.first + 66, line.first + 68}.to_int();
+
+    chunk.edges.emplace_back(node_index_a, node_index_b);
+
+    if (nscore_a == 0 && nscore_b == 0) {
+      chunk.edges.emplace_back(node_index_b, node_index_a);
+    }
+  });
+}
+
+// Builds every node's adjacency from a buffered edge list in two linear sweeps:
+// all successors first, then all predecessors, so succ_push never has to shift predecessors.
+// An edge that would take either end past MaxDegree is dropped with a warning, instead of
+// overwriting the next node; CsrGraph has no such limit.
 template<typename TNode>
-void read_massey(FastGraph<TNode>& g) {
-  auto name_map = load_csv();
+void build_adjacency(FastGraph<TNode>& g, const std::vector<std::pair<uint32_t, uint32_t>>& edges) {
+  std::vector<size_t> degree(g.nodes.size(), 0);
+  std::vector<bool> fits(edges.size());
+  size_t dropped = 0;
+  for (size_t i = 0; i < edges.size(); ++i) {
+    fits[i] = degree[edges[i].first] < TNode::max_degree && degree[edges[i].second] < TNode::max_degree;
+    if (fits[i]) {
+      degree[edges[i].first] += 1;
+      degree[edges[i].second] += 1;
+    } else {
+      dropped += 1;
+    }
+  }
+  if (dropped) {
+    std::cout << "Dropped " << dropped << " edges past MaxDegree=" << (size_t)TNode::max_degree << "; use k_csr_graph" << std::endl;
+  }
   
-  std::ifstream infile;
-//  infile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-  infile.open("edges.txt");
-//  std::cout << "Hello???" << std::endl;
-  std::string line;
-  while (std::getline(infile, line))
-  {
-//    std::cout << line << std::endl;
-    std::string node_name_a(line.cbegin() + 12, line.cbegin() + 37);
-    std::string score_a(line.cbegin() + 37, line.cbegin() + 39);
-    std::string node_name_b(line.cbegin() + 41, line.cbegin() + 66);
-    std::string score_b(line.cbegin() + 66, line.cbegin() + 68);
-    
-    node_name_a = name_map[trim(node_name_a)];
-    node_name_b = name_map[trim(node_name_b)];
-    int nscore_a = atoi(score_a.c_str());
-    int nscore_b = atoi(score_b.c_str());
-    
-    auto node_a = std::find(g.names.cbegin(), g.names.cend(), node_name_a);
-    if (node_a == g.names.cend())
-    {
-      g.names.push_back(node_name_a);
-      g.nodes.emplace_back();
+  for (size_t i = 0; i < edges.size(); ++i) {
+    if (fits[i]) g.nodes[edges[i].first].succ_push(edges[i].second);
+  }
+  for (size_t i = 0; i < edges.size(); ++i) {
+    if (fits[i]) g.nodes[edges[i].second].pred_push(edges[i].first);
+  }
+}
+
+// Reads edges.txt and names.csv in place through mmap.
+// With threads > 1 the edge file is split into that many chunks at line boundaries and parsed
+// in parallel; chunks are then merged in file order, so node ids match the serial parse exactly.
+template<typename TGraph>
+void read_massey(TGraph& g, bool validate = true, unsigned threads = 1) {
+  MappedFile names_file("names.csv");
+  MappedFile edges_file("edges.txt");
+  const NameMap name_map = load_csv(names_file);
+
+  if (threads < 1 || edges_file.size() == 0) threads = 1;
+  std::vector<const char*> bounds{edges_file.begin()};
+  for (unsigned i = 1; i < threads; ++i) {
+    const char* split = std::max(bounds.back(), edges_file.begin() + edges_file.size() * i / threads);
+    const char* newline = static_cast<const char*>(memchr(split, '\n', edges_file.end() - split));
+    bounds.push_back(newline ? newline + 1 : edges_file.end());
+  }
+  bounds.push_back(edges_file.end());
+
+  std::vector<MasseyChunk> chunks(threads);
+  if (threads == 1) {
+    parse_massey_chunk(bounds[0], bounds[1], name_map, chunks[0]);
+  } else {
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; ++i) {
+      workers.emplace_back([&, i]{ parse_massey_chunk(bounds[i], bounds[i + 1], name_map, chunks[i]); });
     }
-    auto node_b = std::find(g.names.cbegin(), g.names.cend(), node_name_b);
-    if (node_b == g.names.cend())
-    {
-      g.names.push_back(node_name_b);
-      g.nodes.emplace_back();
+    for (auto& worker: workers) {
+      worker.join();
     }
-    
-    uint16_t node_index_a = std::find(g.names.cbegin(), g.names.cend(), node_name_a) - g.names.cbegin();
-    uint16_t node_index_b = std::find(g.names.cbegin(), g.names.cend(), node_name_b) - g.names.cbegin();
-    
-//    std::cout << node_name_a << " (index " << node_index_a << ") beat " << node_name_b << " (index " << node_index_b << ")" << std::endl;
-    
-    g.nodes[node_index_a].succ_push(node_index_b);
-    g.nodes[node_index_b].pred_push(node_index_a);
-    
-    if (nscore_a == 0 && nscore_b == 0) {
-      g.nodes[node_index_b].succ_push(node_index_a);
-      g.nodes[node_index_a].pred_push(node_index_b);
+  }
+
+  // Merge chunk-local ids into global ids.
+  std::unordered_map<Slice, uint32_t, SliceHash> node_index;
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+  for (auto& chunk: chunks) {
+    std::vector<uint32_t> remap;
+    remap.reserve(chunk.names.size());
+    for (const Slice& name: chunk.names) {
+      auto inserted = node_index.emplace(name, (uint32_t)g.names.size());
+      if (inserted.second) {
+        g.names.push_back(name.str());
+        g.original_ids.push_back(inserted.first->second);
+      }
+      remap.push_back(inserted.first->second);
+    }
+    for (const auto& edge: chunk.edges) {
+      edges.emplace_back(remap[edge.first], remap[edge.second]);
     }
-    
+  }
+
+  g.nodes.resize(g.names.size());
+  build_adjacency(g, edges);
+
+  if (validate) {
     g.check();
   }
 }
@@ -8,12 +8,17 @@
 
 #define NDEBUG
 #include <cassert>
+#include <chrono>
+#include <random>
 
 #include "Node.h"
 #include "FastGraph.h"
 #include "io_util.hpp"
 #include "graph_operations.h"
+#include "dispatch.h"
 #include "evolution.h"
+#include "reduction.h"
+#include "snapshot.h"
 
 void test_cross() {
   auto g = cycle<uint16_t, uint8_t, 15>(16);
@@ -41,7 +46,8 @@ void test_cross() {
     assert(t1.path[i] == t2.path[i]);
   }
   
-  t2 = cross_faster(g, site, mother, father);
+  SearchContext<uint16_t> context(g.nodes.size());
+  t2 = cross_faster(g, site, mother, father, context);
   
   assert(t1.path.size() == t2.path.size());
   for (int i = 0; i < t1.path.size(); ++i) {
@@ -88,6 +94,158 @@ void test_has_path() {
   }
 }
 
+template<typename TSet, typename TSearch>
+double time_has_path(const std::vector<Gene<uint16_t>>& queries, std::vector<bool>& answers, TSearch search) {
+  auto start = std::chrono::steady_clock::now();
+  answers.clear();
+  for (const auto& query: queries) {
+    TSet forbidden = {};
+    flatten(forbidden, query.path.cbegin() + 1, query.path.cend() - 1);
+    answers.push_back(search(query.path.back(), query.path.front(), forbidden));
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / queries.size();
+}
+
+// Random simple paths through g, shaped like the closability queries the evolution issues.
+std::vector<Gene<uint16_t>> random_path_queries(const FastGraph<Node<uint16_t, uint8_t, 15>>& g, size_t count, std::mt19937& rng) {
+  std::vector<Gene<uint16_t>> queries;
+  while (queries.size() < count) {
+    std::uniform_int_distribution<uint16_t> start(0, g.nodes.size() - 1);
+    Gene<uint16_t> walk;
+    walk.path.push_back(start(rng));
+    std::vector<bool> visited(g.nodes.size(), false);
+    visited[walk.path.back()] = true;
+    std::uniform_int_distribution<size_t> length(2, g.nodes.size() / 2);
+    for (size_t target_length = length(rng); walk.path.size() < target_length;) {
+      const auto& node = g.nodes[walk.path.back()];
+      if (node.get_out_degree() == 0) break;
+      std::uniform_int_distribution<int> pick(0, node.get_out_degree() - 1);
+      uint16_t next = node.succ_cbegin()[pick(rng)];
+      if (visited[next]) break;
+      visited[next] = true;
+      walk.path.push_back(next);
+    }
+    if (walk.path.size() >= 2) queries.push_back(walk);
+  }
+  return queries;
+}
+
+// Compares the original two-byte NodeSet layout against the bit-packed one,
+// and the per-neighbor BFS against the bitset-frontier BFS, on closability queries
+// shaped like the ones the evolution issues: random simple paths through the SCC.
+void benchmark_has_path() {
+  FastGraph<Node<uint16_t, uint8_t, 15>> g;
+  read_massey(g);
+  restrict_to_scc(g, (uint16_t)0);
+  // Size class of the Massey SCC.
+  constexpr size_t capacity = 1024;
+  typedef SlotNodeSet<capacity> Slots;
+  typedef BitNodeSet<capacity> Bits;
+  if (g.nodes.size() > capacity) {
+    std::cout << "benchmark_has_path needs at most " << capacity << " nodes" << std::endl;
+    return;
+  }
+  BitAdjacency<capacity> adjacency = make_bit_adjacency<capacity>(g);
+  SearchContext<uint16_t, capacity> context(g.nodes.size());
+  
+  std::mt19937 rng(k_random_seed);
+  std::vector<Gene<uint16_t>> queries = random_path_queries(g, 100000, rng);
+  
+  std::vector<bool> slot_answers, bit_answers, frontier_answers;
+  double slot_ns = time_has_path<Slots>(queries, slot_answers, [&](uint16_t s, uint16_t t, const Slots& f) {
+    return has_path(g, s, t, f, context);
+  });
+  double bit_ns = time_has_path<Bits>(queries, bit_answers, [&](uint16_t s, uint16_t t, const Bits& f) {
+    return has_path(g, s, t, f, context);
+  });
+  double frontier_ns = time_has_path<Bits>(queries, frontier_answers, [&](uint16_t s, uint16_t t, const Bits& f) {
+    return has_path(adjacency, s, t, f);
+  });
+  
+  std::cout << queries.size() << " has_path queries on " << g.nodes.size() << " nodes" << std::endl;
+  std::cout << "  SlotNodeSet, neighbor lists: " << slot_ns << " ns/query" << std::endl;
+  std::cout << "  BitNodeSet, neighbor lists:  " << bit_ns << " ns/query" << std::endl;
+  std::cout << "  BitNodeSet, bit frontiers:   " << frontier_ns << " ns/query" << std::endl;
+  if (slot_answers != bit_answers || slot_answers != frontier_answers) {
+    std::cout << "  MISMATCH between search variants!" << std::endl;
+  }
+}
+
+// Times has_path and cross_faster under each node numbering. The work is identical:
+// queries and crossovers are drawn once in input order and renumbered for each graph.
+void benchmark_node_order() {
+  FastGraph<Node<uint16_t, uint8_t, 15>> input;
+  read_massey(input);
+  restrict_to_scc(input, (uint16_t)0);
+  constexpr size_t capacity = 4096;
+  if (input.nodes.size() > capacity) {
+    std::cout << "benchmark_node_order needs at most " << capacity << " nodes" << std::endl;
+    return;
+  }
+  
+  std::mt19937 rng(k_random_seed);
+  const std::vector<Gene<uint16_t>> queries = random_path_queries(input, 100000, rng);
+  
+  // A population that has evolved for a while, and the crossovers its next generation would make.
+  Evolver<uint16_t, capacity> evolver;
+  evolver.rng.seed(k_random_seed);
+  evolver.age = 0;
+  evolver.population = get_reversible_edges(input, evolver.rng, evolver.context);
+  evolve(input, evolver, 50);
+  struct Crossover { uint16_t site; uint32_t mother; uint32_t father; };
+  std::vector<Crossover> crossovers;
+  std::vector<std::vector<uint32_t>> site_to_gene_pool(input.nodes.size());
+  for (uint32_t igene = 0; igene < evolver.population.size(); ++igene) {
+    for (const uint16_t isite: evolver.population[igene].path) {
+      site_to_gene_pool[isite].push_back(igene);
+    }
+  }
+  for (int repeat = 0; repeat < 20; ++repeat) {
+    for (uint16_t isite = 0; isite < input.nodes.size(); ++isite) {
+      const auto& candidates = site_to_gene_pool[isite];
+      if (candidates.empty()) continue;
+      std::uniform_int_distribution<size_t> gene_chooser(0, candidates.size() - 1);
+      crossovers.push_back(Crossover{isite, candidates[gene_chooser(rng)], candidates[gene_chooser(rng)]});
+    }
+  }
+  
+  std::cout << queries.size() << " has_path queries and " << crossovers.size() << " crossovers on "
+            << input.nodes.size() << " nodes" << std::endl;
+  const NodeOrder orders[] = {NodeOrder::input, NodeOrder::bfs, NodeOrder::rcm, NodeOrder::degree};
+  const char* order_names[] = {"input ", "bfs   ", "rcm   ", "degree"};
+  for (int i = 0; i < 4; ++i) {
+    FastGraph<Node<uint16_t, uint8_t, 15>> g = input;
+    const std::vector<uint32_t> remap = relabel(g, node_order(g, orders[i]));
+    std::vector<Gene<uint16_t>> relabeled_queries;
+    for (const auto& query: queries) relabeled_queries.push_back(relabel(query, remap));
+    std::vector<Gene<uint16_t>> population;
+    for (const auto& gene: evolver.population) population.push_back(relabel(gene, remap));
+    SearchContext<uint16_t, capacity> context(g.nodes.size());
+    
+    std::vector<bool> answers;
+    double has_path_ns = time_has_path<NodeSetOf<capacity>>(relabeled_queries, answers, [&](uint16_t s, uint16_t t, const NodeSetOf<capacity>& f) {
+      return has_path(g, s, t, f, context);
+    });
+    
+    size_t total_length = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& crossover: crossovers) {
+      total_length += cross_faster(g, (uint16_t)remap[crossover.site], population[crossover.mother], population[crossover.father], context).path.size();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    
+    std::cout << "  " << order_names[i] << ": " << has_path_ns << " ns/has_path, "
+              << elapsed.count() / crossovers.size() << " ns/cross_faster"
+              << " (" << std::count(answers.begin(), answers.end(), true) << " paths, total length " << total_length << ")" << std::endl;
+  }
+}
+
+// k_parse_threads, with 0 resolved to the hardware thread count.
+unsigned parse_threads() {
+  return k_parse_threads ? k_parse_threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
 int main() {
 //  std::cout << alignof(std::max_align_t) << '\n'; exit(0);
   
@@ -97,11 +255,72 @@ int main() {
 //  test_cross();
 //  exit(0);
   
-  FastGraph<Node<uint16_t, uint8_t, 15>> g;
-  read_massey(g);
-  std::cout << g.nodes.size() << " nodes in input" << std::endl;
-  restrict_to_scc(g, (uint16_t)0);
-  std::cout << g.nodes.size() << " nodes in SCC" << std::endl;
+//  benchmark_has_path();
+//  exit(0);
+  
+//  benchmark_node_order();
+//  exit(0);
+  
+  if (k_csr_graph) {
+    CsrGraph<uint16_t> g;
+    read_massey(g, true, parse_threads());
+    std::cout << g.nodes.size() << " nodes in input" << std::endl;
+    restrict_to_scc(g, (uint16_t)0);
+    std::cout << g.nodes.size() << " nodes in SCC" << std::endl;
+    if (k_edge_matrix) index_edges(g);
+    if (k_dominator_filter) index_dominators(g, k_dominator_max_nodes);
+    evolve(g);
+    return 0;
+  }
+  
+  FastGraph<InputNode> g;
+  if (k_solve_all_components) {
+    read_massey(g, true, parse_threads());
+    std::cout << g.nodes.size() << " nodes in input" << std::endl;
+  } else {
+    if (k_use_snapshot && load_snapshot(g, k_snapshot_path)) {
+      std::cout << "Loaded " << k_snapshot_path << std::endl;
+    } else {
+      read_massey(g, true, parse_threads());
+      std::cout << g.nodes.size() << " nodes in input" << std::endl;
+      restrict_to_scc(g, (uint16_t)0);
+      if (k_use_snapshot) save_snapshot(g, k_snapshot_path);
+    }
+    std::cout << g.nodes.size() << " nodes in SCC" << std::endl;
+  }
+  
+  if (k_node_order != NodeOrder::input) {
+    // Names and original_ids follow the nodes, so records still print team names.
+    relabel(g, node_order(g, k_node_order));
+  }
+  
+  Record record;
+  // The graph as it was before reduction, and the way back to it, for printing records.
+  FastGraph<InputNode> unreduced;
+  Reduction<InputNode> reduction;
+  if (k_reduce_graph) {
+    reduction = reduce(g);
+    unreduced = std::move(g);
+    g = reduction.reduced;
+    record.print_expanded = [&](const std::vector<uint32_t>& cycle) { print(unreduced, expand(reduction, cycle)); };
+    std::cout << g.nodes.size() << " nodes after reduction" << std::endl;
+  }
+  
+  if (k_solve_all_components || k_split_into_blocks) {
+    auto parts = k_split_into_blocks ? split_into_blocks(g) : split_into_sccs(g);
+    std::cout << parts.size() << " components with cycles" << std::endl;
+    if (k_edge_matrix) {
+      for (auto& part: parts) index_edges(part);
+    }
+    if (k_dominator_filter) {
+      for (auto& part: parts) index_dominators(part, k_dominator_max_nodes);
+    }
+    with_tightest_nodes(parts, EvolveComponents{record});
+    return 0;
+  }
+  
 //  exit(0);
-  evolve(g);
+  if (k_edge_matrix) index_edges(g);
+  if (k_dominator_filter) index_dominators(g, k_dominator_max_nodes);
+  with_tightest_nodes(std::vector<FastGraph<InputNode>>{g}, EvolveOne{record});
 }
\ No newline at end of file
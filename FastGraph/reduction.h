@@ -0,0 +1,163 @@
+//
+//  reduction.h
+//  FastGraph
+//
+//  Created by culter on 10/18/26.
+//  Copyright © 2026 culter. All rights reserved.
+//
+
+#ifndef reduction_h
+#define reduction_h
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "FastGraph.h"
+#include "Gene.h"
+#include "graph_operations.h"
+
+// A smaller graph with the same longest cycle, plus the way back to the input graph.
+template<typename TNode>
+struct Reduction {
+  FastGraph<TNode> reduced;
+  // The input-graph nodes each reduced node stands for, in path order.
+  std::vector<std::vector<uint32_t>> members;
+};
+
+// Three exact reductions, all O(V+E):
+//  1. Parallel edges from repeat matchups collapse to one.
+//  2. Self-loops and edges between different SCCs are dropped; no simple cycle can use them.
+//  3. An edge v->w with out_degree(v) == 1 and in_degree(w) == 1 is on every cycle through
+//     v or w, so maximal paths of such edges contract into single nodes whose weight is the
+//     path length. (One side alone is not enough: with only out_degree(v) == 1, cycles may
+//     still reach w without passing through v.) Nothing is contracted into a self-loop: a
+//     component that is one forced cycle is left alone, and a chain whose tail points back
+//     at its head keeps the tail separate.
+template<typename TIndex, typename TDegree, size_t MaxDegree>
+Reduction<Node<TIndex, TDegree, MaxDegree>> reduce(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g) {
+  constexpr uint32_t none = UINT32_MAX;
+  const uint32_t n = (uint32_t)g.nodes.size();
+  const Components components = strongly_connected_components(g);
+
+  // 1 and 2: the surviving successors of every node, in their original order.
+  std::vector<std::vector<uint32_t>> succ(n);
+  std::vector<uint32_t> in_degree(n, 0);
+  for (uint32_t v = 0; v < n; ++v) {
+    for (auto w = g.nodes[v].succ_cbegin(); w != g.nodes[v].succ_cend(); ++w) {
+      if (*w == v || components.membership[*w] != components.membership[v]) continue;
+      if (std::find(succ[v].begin(), succ[v].end(), (uint32_t)*w) != succ[v].end()) continue;
+      succ[v].push_back(*w);
+      in_degree[*w] += 1;
+    }
+  }
+
+  // 3: forced edges form disjoint simple paths and cycles.
+  std::vector<uint32_t> forced_next(n, none);
+  std::vector<uint32_t> forced_prev(n, none);
+  for (uint32_t v = 0; v < n; ++v) {
+    if (succ[v].size() == 1 && in_degree[succ[v][0]] == 1) {
+      forced_next[v] = succ[v][0];
+      forced_prev[succ[v][0]] = v;
+    }
+  }
+
+  std::vector<uint32_t> chain_of(n, none);
+  std::vector<std::vector<uint32_t>> chains;
+  for (uint32_t head = 0; head < n; ++head) {
+    if (forced_prev[head] != none) continue;
+    chains.emplace_back();
+    for (uint32_t v = head; v != none; v = forced_next[v]) {
+      chain_of[v] = (uint32_t)chains.size() - 1;
+      chains.back().push_back(v);
+    }
+    // An edge from the tail back to the head would become a self-loop; split the tail off
+    // so that cycle survives as a 2-cycle.
+    const uint32_t tail = chains.back().back();
+    if (chains.back().size() > 1 && std::find(succ[tail].begin(), succ[tail].end(), head) != succ[tail].end()) {
+      chains.back().pop_back();
+      chain_of[tail] = (uint32_t)chains.size();
+      chains.push_back(std::vector<uint32_t>{tail});
+    }
+  }
+  // Whatever is left lies on a cycle of forced edges; keep those nodes uncontracted.
+  for (uint32_t v = 0; v < n; ++v) {
+    if (chain_of[v] == none) {
+      chain_of[v] = (uint32_t)chains.size();
+      chains.push_back(std::vector<uint32_t>{v});
+    }
+  }
+  // Keep reduced ids in the order of each chain's first input node.
+  std::vector<uint32_t> order(chains.size());
+  for (uint32_t c = 0; c < chains.size(); ++c) order[c] = c;
+  std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    return *std::min_element(chains[a].begin(), chains[a].end()) < *std::min_element(chains[b].begin(), chains[b].end());
+  });
+  std::vector<uint32_t> reduced_id(chains.size());
+  for (uint32_t r = 0; r < order.size(); ++r) reduced_id[order[r]] = r;
+
+  Reduction<Node<TIndex, TDegree, MaxDegree>> answer;
+  FastGraph<Node<TIndex, TDegree, MaxDegree>>& reduced = answer.reduced;
+  const uint32_t m = (uint32_t)chains.size();
+  reduced.nodes.resize(m);
+  reduced.names.resize(m);
+  reduced.original_ids.resize(m);
+  reduced.weights.resize(m);
+  answer.members.resize(m);
+  for (uint32_t c = 0; c < m; ++c) {
+    const uint32_t r = reduced_id[c];
+    answer.members[r] = chains[c];
+    reduced.original_ids[r] = g.original_ids[chains[c].front()];
+    reduced.weights[r] = 0;
+    for (size_t i = 0; i < chains[c].size(); ++i) {
+      reduced.weights[r] += (uint32_t)g.weight(chains[c][i]);
+      if (i > 0) reduced.names[r] += " > ";
+      reduced.names[r] += g.names[chains[c][i]];
+    }
+  }
+
+  // Only the tail of a chain has outgoing edges besides the forced ones.
+  std::vector<std::pair<uint32_t, uint32_t>> edges;
+  for (uint32_t c = 0; c < m; ++c) {
+    const uint32_t tail = chains[c].back();
+    for (const uint32_t w: succ[tail]) {
+      edges.emplace_back(reduced_id[c], reduced_id[chain_of[w]]);
+    }
+  }
+  std::stable_sort(edges.begin(), edges.end(), [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+    return a.first < b.first;
+  });
+  for (const auto& edge: edges) {
+    reduced.nodes[edge.first].succ_push(edge.second);
+  }
+  for (const auto& edge: edges) {
+    reduced.nodes[edge.second].pred_push(edge.first);
+  }
+
+  return answer;
+}
+
+// Rewrites a cycle of the reduced graph as the cycle of input-graph nodes it stands for.
+// The result is in the input graph's index type, which may be wider than the gene's.
+template<typename TNode, typename TIndex>
+Gene<typename TNode::index_type> expand(const Reduction<TNode>& reduction, const Gene<TIndex>& gene) {
+  Gene<typename TNode::index_type> answer;
+  for (const TIndex r: gene.path) {
+    answer.path.insert(answer.path.end(), reduction.members[r].cbegin(), reduction.members[r].cend());
+  }
+  return answer;
+}
+
+// The same for a cycle given by the original_ids of its nodes, which survive the copies,
+// relabelings and component splits the reduced graph goes through before it is searched.
+template<typename TNode>
+Gene<typename TNode::index_type> expand(const Reduction<TNode>& reduction, const std::vector<uint32_t>& cycle) {
+  const std::vector<uint32_t>& ids = reduction.reduced.original_ids;
+  std::vector<uint32_t> reduced_of(*std::max_element(ids.begin(), ids.end()) + 1, 0);
+  for (uint32_t r = 0; r < ids.size(); ++r) reduced_of[ids[r]] = r;
+  Gene<uint32_t> gene;
+  for (const uint32_t id: cycle) gene.path.push_back(reduced_of[id]);
+  return expand(reduction, gene);
+}
+
+#endif /* reduction_h */
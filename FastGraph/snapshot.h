@@ -0,0 +1,206 @@
+//
+//  snapshot.h
+//  FastGraph
+//
+//  Created by culter on 10/18/26.
+//  Copyright © 2026 culter. All rights reserved.
+//
+
+#ifndef snapshot_h
+#define snapshot_h
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+#include "FastGraph.h"
+#include "Node.h"
+#include "io_util.hpp"
+
+// Binary image of a prepared (post-SCC) graph:
+//   SnapshotHeader
+//   TNode    nodes[node_count]
+//   uint32_t original_ids[node_count]
+//   uint32_t name_offsets[node_count + 1]
+//   char     names[names_bytes]
+// The header records the Node layout, so a build with a different TIndex, TDegree or
+// MaxDegree refuses the file instead of misreading it. It also records the size and
+// modification time of the text inputs, so editing edges.txt invalidates the snapshot.
+
+constexpr static const char k_snapshot_magic[8] = {'F', 'G', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr static const uint32_t k_snapshot_version = 1;
+constexpr static const uint32_t k_snapshot_byte_order = 0x01020304;
+
+struct SourceStamp {
+  uint64_t size;
+  int64_t mtime;
+
+  static SourceStamp of(const char* path) {
+    struct stat info;
+    if (stat(path, &info) != 0) return SourceStamp{0, 0};
+    return SourceStamp{(uint64_t)info.st_size, (int64_t)info.st_mtime};
+  }
+  bool operator==(const SourceStamp& other) const { return size == other.size && mtime == other.mtime; }
+};
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t index_size;
+  uint32_t degree_size;
+  uint32_t max_degree;
+  uint32_t node_size;
+  uint64_t node_count;
+  uint64_t names_bytes;
+  SourceStamp edges_source;
+  SourceStamp names_source;
+};
+
+template<typename TIndex, typename TDegree, size_t MaxDegree>
+SnapshotHeader make_snapshot_header(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g) {
+  SnapshotHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, k_snapshot_magic, sizeof(header.magic));
+  header.version = k_snapshot_version;
+  header.byte_order = k_snapshot_byte_order;
+  header.index_size = sizeof(TIndex);
+  header.degree_size = sizeof(TDegree);
+  header.max_degree = MaxDegree;
+  header.node_size = sizeof(Node<TIndex, TDegree, MaxDegree>);
+  header.node_count = g.nodes.size();
+  header.edges_source = SourceStamp::of("edges.txt");
+  header.names_source = SourceStamp::of("names.csv");
+  return header;
+}
+
+template<typename TIndex, typename TDegree, size_t MaxDegree>
+bool save_snapshot(const FastGraph<Node<TIndex, TDegree, MaxDegree>>& g, const char* path) {
+  typedef Node<TIndex, TDegree, MaxDegree> TNode;
+  static_assert(std::is_trivially_copyable<TNode>::value, "Snapshots store nodes as raw bytes");
+
+  SnapshotHeader header = make_snapshot_header(g);
+  std::vector<uint32_t> name_offsets{0};
+  for (const auto& name: g.names) {
+    name_offsets.push_back(name_offsets.back() + (uint32_t)name.size());
+  }
+  header.names_bytes = name_offsets.back();
+
+  // Write next to the target and rename, so concurrent runs never see a half-written file.
+  std::string temp_path = std::string(path) + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(g.nodes.data()), g.nodes.size() * sizeof(TNode));
+    out.write(reinterpret_cast<const char*>(g.original_ids.data()), g.original_ids.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(name_offsets.data()), name_offsets.size() * sizeof(uint32_t));
+    for (const auto& name: g.names) {
+      out.write(name.data(), name.size());
+    }
+    if (!out) {
+      std::cout << "Could not write snapshot " << temp_path << std::endl;
+      std::remove(temp_path.c_str());
+      return false;
+    }
+  }
+  return std::rename(temp_path.c_str(), path) == 0;
+}
+
+// Returns false, leaving g untouched, if there is no usable snapshot at path.
+template<typename TIndex, typename TDegree, size_t MaxDegree>
+bool load_snapshot(FastGraph<Node<TIndex, TDegree, MaxDegree>>& g, const char* path) {
+  typedef Node<TIndex, TDegree, MaxDegree> TNode;
+
+  if (access(path, R_OK) != 0) return false;
+  MappedFile file(path);
+  if (file.size() < sizeof(SnapshotHeader)) {
+    std::cout << "Ignoring snapshot " << path << ": truncated" << std::endl;
+    return false;
+  }
+
+  SnapshotHeader header;
+  memcpy(&header, file.begin(), sizeof(header));
+  const SnapshotHeader expected = make_snapshot_header(g);
+  if (memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+      header.version != expected.version ||
+      header.byte_order != expected.byte_order) {
+    std::cout << "Ignoring snapshot " << path << ": not a version " << k_snapshot_version << " snapshot" << std::endl;
+    return false;
+  }
+  if (header.index_size != expected.index_size ||
+      header.degree_size != expected.degree_size ||
+      header.max_degree != expected.max_degree ||
+      header.node_size != expected.node_size) {
+    std::cout << "Ignoring snapshot " << path << ": written for Node<" << header.index_size << "-byte index, "
+              << header.degree_size << "-byte degree, " << header.max_degree << ">" << std::endl;
+    return false;
+  }
+  if (!(header.edges_source == expected.edges_source) || !(header.names_source == expected.names_source)) {
+    std::cout << "Ignoring snapshot " << path << ": edges.txt or names.csv has changed" << std::endl;
+    return false;
+  }
+
+  // Sizes come from the file, so check them against its length before any pointer math.
+  const size_t body = file.size() - sizeof(SnapshotHeader);
+  const size_t per_node = sizeof(TNode) + 2 * sizeof(uint32_t);
+  if (body < sizeof(uint32_t) ||
+      header.node_count > (body - sizeof(uint32_t)) / per_node ||
+      header.names_bytes != body - sizeof(uint32_t) - header.node_count * per_node) {
+    std::cout << "Ignoring snapshot " << path << ": truncated" << std::endl;
+    return false;
+  }
+  const size_t n = header.node_count;
+  const char* nodes = file.begin() + sizeof(SnapshotHeader);
+  const char* original_ids = nodes + n * sizeof(TNode);
+  const char* name_offsets = original_ids + n * sizeof(uint32_t);
+  const char* names = name_offsets + (n + 1) * sizeof(uint32_t);
+
+  std::vector<uint32_t> offsets(n + 1);
+  memcpy(offsets.data(), name_offsets, (n + 1) * sizeof(uint32_t));
+  if (offsets[0] != 0 || offsets[n] != header.names_bytes ||
+      !std::is_sorted(offsets.begin(), offsets.end())) {
+    std::cout << "Ignoring snapshot " << path << ": corrupt names table" << std::endl;
+    return false;
+  }
+
+  // Each section is one bulk copy, but FastGraph owns its nodes and names, so they cannot be
+  // used in place: names still cost one string per node.
+  std::vector<TNode> loaded_nodes(n);
+  memcpy(loaded_nodes.data(), nodes, n * sizeof(TNode));
+  std::vector<uint32_t> loaded_ids(n);
+  memcpy(loaded_ids.data(), original_ids, n * sizeof(uint32_t));
+
+  // FastGraph::check() is compiled out under NDEBUG, so check what later code indexes with.
+  for (const TNode& node: loaded_nodes) {
+    if ((size_t)node.get_out_degree() + node.get_in_degree() > MaxDegree ||
+        std::any_of(node.succ_cbegin(), node.pred_cend(), [n](TIndex v) { return (size_t)v >= n; })) {
+      std::cout << "Ignoring snapshot " << path << ": corrupt node table" << std::endl;
+      return false;
+    }
+  }
+  // restrict_to_scc keeps input order, and every input node is named in edges.txt.
+  if (std::adjacent_find(loaded_ids.begin(), loaded_ids.end(), std::greater_equal<uint32_t>()) != loaded_ids.end() ||
+      (n && loaded_ids.back() >= header.edges_source.size)) {
+    std::cout << "Ignoring snapshot " << path << ": corrupt original ids" << std::endl;
+    return false;
+  }
+
+  g.nodes = std::move(loaded_nodes);
+  g.original_ids = std::move(loaded_ids);
+  g.names.clear();
+  g.names.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    g.names.emplace_back(names + offsets[i], names + offsets[i + 1]);
+  }
+  return true;
+}
+
+#endif /* snapshot_h */